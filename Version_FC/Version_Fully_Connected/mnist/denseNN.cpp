@@ -28,6 +28,17 @@ Tensor DenseNN::forward(const Tensor& x) {
                             layer1_.forward(x)))))));
 }
 
+/* ───────── const inference pass (no cache, thread-safe) ───────── */
+Tensor DenseNN::infer(const Tensor& x) const {
+    return layer4_.infer(
+        relu3_.infer(
+            layer3_.infer(
+                relu2_.infer(
+                    layer2_.infer(
+                        relu1_.infer(
+                            layer1_.infer(x)))))));
+}
+
 /* ───────── single-sample training step ───────── */
 float DenseNN::train_one(const Tensor& x, Label y)
 {
@@ -62,9 +73,9 @@ float DenseNN::train_one(const Tensor& x, Label y)
 }
 
 /* ───────── inference ───────── */
-int DenseNN::predict(const Tensor& x)
+int DenseNN::predict(const Tensor& x) const
 {
-    const Tensor y = forward(x);
+    const Tensor y = infer(x);
     return static_cast<int>(std::distance(
         y.begin(), std::max_element(y.begin(), y.end())));
 }
\ No newline at end of file
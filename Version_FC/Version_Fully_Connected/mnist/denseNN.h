@@ -7,10 +7,13 @@ class DenseNN
 public:
     explicit DenseNN(float lr, std::mt19937& g);
 
-    // NOTE:  ► no "const" on these ◄
+    // NOTE:  ► no "const" on these ◄  (training path, layers keep caches)
     Tensor forward(const Tensor& img);
     float  train_one(const Tensor& img, Label y);
-    int    predict(const Tensor& img);
+
+    // const inference path: no cache written, safe to share across threads
+    Tensor infer(const Tensor& img) const;
+    int    predict(const Tensor& img) const;
 
 private:
     Dense layer1_;    // Input layer (IMG_SIZE*IMG_SIZE -> 256)
@@ -16,6 +16,9 @@ int ConvLayer::idx(int c, int y, int x, int C, int H, int W) const {
 }
 Tensor ConvLayer::forward(const Tensor& in) {
     cache_ = in;
+    return infer(in);
+}
+Tensor ConvLayer::infer(const Tensor& in) const {
     const int H = IMG_SIZE;
     Tensor out(outC_ * H * H);
     for (int oc = 0; oc < outC_; ++oc) {            
@@ -63,7 +66,11 @@ Tensor ConvLayer::backward(const Tensor& g, float lr) {
 
 /* ───────── ReLU ───────── */
 Tensor ReLU::forward(const Tensor& in) {
-    cache_ = in; Tensor y(in.size());
+    cache_ = in;
+    return infer(in);
+}
+Tensor ReLU::infer(const Tensor& in) const {
+    Tensor y(in.size());
     for (size_t i = 0; i < in.size(); ++i) y[i] = in[i] > 0 ? in[i] : 0;
     return y;
 }
@@ -77,24 +84,37 @@ Tensor ReLU::backward(const Tensor& g) {
 int MaxPool::idx(int c, int y, int x, int C, int H, int W) const {
     return c * H * W + y * W + x;
 }
-Tensor MaxPool::forward(const Tensor& in) {
-    C_ = (int)in.size() / (IMG_SIZE * IMG_SIZE);
-    H_ = IMG_SIZE / 2; W_ = H_;
-    Tensor out(C_ * H_ * W_);
-    argmax_.clear(); argmax_.reserve(out.size());
-    for (int c = 0; c < C_; ++c)                                      
-        for (int y = 0; y < H_; ++y)
-            for (int x = 0; x < W_; ++x) {
+/*  Noyau commun à forward et infer : `argmax` reçoit l'indice du
+    maximum de chaque fenêtre, ou vaut nullptr sans backward. */
+void MaxPool::pool(const Tensor& in, Tensor& out, std::vector<int>* argmax,
+                   int C, int H, int W) const {
+    for (int c = 0; c < C; ++c)
+        for (int y = 0; y < H; ++y)
+            for (int x = 0; x < W; ++x) {
                 float best = -1e9f; int best_i = 0;
                 for (int py = 0; py < 2; ++py)
                     for (int px = 0; px < 2; ++px) {
                         int iy = y * 2 + py, ix = x * 2 + px;
-                        int i = idx(c, iy, ix, C_, IMG_SIZE, IMG_SIZE);
+                        int i = idx(c, iy, ix, C, IMG_SIZE, IMG_SIZE);
                         if (in[i] > best) { best = in[i]; best_i = i; }
                     }
-                out[idx(c, y, x, C_, H_, W_)] = best;
-                argmax_.push_back(best_i);
+                out[idx(c, y, x, C, H, W)] = best;
+                if (argmax) argmax->push_back(best_i);
             }
+}
+Tensor MaxPool::forward(const Tensor& in) {
+    C_ = (int)in.size() / (IMG_SIZE * IMG_SIZE);
+    H_ = IMG_SIZE / 2; W_ = H_;
+    Tensor out(C_ * H_ * W_);
+    argmax_.clear(); argmax_.reserve(out.size());
+    pool(in, out, &argmax_, C_, H_, W_);
+    return out;
+}
+Tensor MaxPool::infer(const Tensor& in) const {
+    const int C = (int)in.size() / (IMG_SIZE * IMG_SIZE);
+    const int H = IMG_SIZE / 2;
+    Tensor out(C * H * H);
+    pool(in, out, nullptr, C, H, H);
     return out;
 }
 Tensor MaxPool::backward(const Tensor& g) {
@@ -111,7 +131,11 @@ Dense::Dense(int inD, int outD, std::mt19937& g) :inD_(inD), outD_(outD) {
     dW_.resize(W_.size()); db_.resize(b_.size());
 }
 Tensor Dense::forward(const Tensor& in) {
-    cache_ = in; Tensor y(outD_);
+    cache_ = in;
+    return infer(in);
+}
+Tensor Dense::infer(const Tensor& in) const {
+    Tensor y(outD_);
     for (int o = 0; o < outD_; ++o) {                              
         float s = b_[o];
         for (int i = 0; i < inD_; ++i) s += in[i] * W_[o * inD_ + i];
@@ -8,6 +8,7 @@ class ConvLayer {
 public:
     ConvLayer(int inC, int outC, int k, std::mt19937& g);
     Tensor forward(const Tensor& in);
+    Tensor infer(const Tensor& in) const;       // sans cache, thread-safe
     Tensor backward(const Tensor& grad, float lr);
 private:
     int inC_, outC_, k_;
@@ -19,6 +20,7 @@ private:
 class ReLU {
 public:
     Tensor forward(const Tensor& in);
+    Tensor infer(const Tensor& in) const;       // sans cache, thread-safe
     Tensor backward(const Tensor& grad);
 private:
     Tensor cache_;
@@ -28,11 +30,14 @@ private:
 class MaxPool {
 public:
     Tensor forward(const Tensor& in);
+    Tensor infer(const Tensor& in) const;       // sans cache, thread-safe
     Tensor backward(const Tensor& grad);
 private:
     int C_, H_, W_;
     std::vector<int> argmax_;
     int idx(int c, int y, int x, int C, int H, int W) const;
+    void pool(const Tensor& in, Tensor& out, std::vector<int>* argmax,
+              int C, int H, int W) const;
 };
 
 /* --- Fully-connected --------------------------------------------- */
@@ -40,6 +45,7 @@ class Dense {
 public:
     Dense(int inD, int outD, std::mt19937& g);
     Tensor forward(const Tensor& in);
+    Tensor infer(const Tensor& in) const;       // sans cache, thread-safe
     Tensor backward(const Tensor& grad, float lr);
 private:
     int inD_, outD_;
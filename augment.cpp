@@ -0,0 +1,288 @@
+#include "augment.h"
+#include "simd.h"
+#include <algorithm>
+#include <cmath>
+
+/* ───────── Générateur déterministe ─────────────────────────────── */
+/*  splitmix64 plutôt que std::mt19937 + distributions : les
+    distributions de la STL ne donnent pas les mêmes tirages d'une
+    bibliothèque standard à l'autre (MSVC / libstdc++). */
+static uint64_t splitmix64(uint64_t& s)
+{
+    uint64_t z = (s += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+/* tirage uniforme dans [-a, a) */
+static float uniform_sym(uint64_t& s, float a)
+{
+    const float u = static_cast<float>(splitmix64(s) >> 40) * (1.0f / 16777216.0f);
+    return a * (2.0f * u - 1.0f);
+}
+
+/* ───────── Géométrie ───────────────────────────────────────────── */
+constexpr int   GRID = 4;                       // grille du champ élastique
+constexpr int   PW   = IMG_SIZE + 3;            // image bordée de zéros
+constexpr int   ROW  = (IMG_SIZE + 7) / 8 * 8;  // ligne arrondie à 8 voies
+constexpr float CTR  = 0.5f * (IMG_SIZE - 1);
+
+/* colonne x -> cellule de grille i et fraction f (constantes) */
+struct GridCols {
+    alignas(32) int   i[ROW];
+    alignas(32) float f[ROW];
+    GridCols() {
+        for (int x = 0; x < ROW; ++x) {
+            const float u = std::min(x, IMG_SIZE - 1) * float(GRID - 1) / (IMG_SIZE - 1);
+            i[x] = std::min(static_cast<int>(u), GRID - 2);
+            f[x] = u - static_cast<float>(i[x]);
+        }
+    }
+};
+static const GridCols COLS;
+
+void augment_image(const Tensor& src, Tensor& dst,
+                   const AugmentParams& p,
+                   uint64_t seed, int epoch, uint64_t sample)
+{
+    /* --- tirage des paramètres de l'échantillon --- */
+    uint64_t s = seed;
+    s ^= splitmix64(s) + static_cast<uint64_t>(epoch);
+    s ^= splitmix64(s) + sample;
+
+    const float th = uniform_sym(s, p.max_rot_deg) * 3.14159265f / 180.f;
+    const float cs = std::cos(th), sn = std::sin(th);
+    const float tx = uniform_sym(s, p.max_shift);
+    const float ty = uniform_sym(s, p.max_shift);
+    float gx[GRID][GRID], gy[GRID][GRID];
+    for (int j = 0; j < GRID; ++j)
+        for (int i = 0; i < GRID; ++i) {
+            gx[j][i] = uniform_sym(s, p.elastic);
+            gy[j][i] = uniform_sym(s, p.elastic);
+        }
+
+    /* --- source bordée : tout point hors image lit des zéros --- */
+    alignas(32) float pad[PW * PW] = {};
+    for (int y = 0; y < IMG_SIZE; ++y)
+        std::copy_n(&src[y * IMG_SIZE], IMG_SIZE, &pad[(y + 1) * PW + 1]);
+
+    dst.resize(IMG_SIZE * IMG_SIZE);
+    alignas(32) float row[ROW];
+
+    for (int y = 0; y < IMG_SIZE; ++y) {
+        /* champ élastique : interpolation des lignes de grille en y */
+        const float v  = y * float(GRID - 1) / (IMG_SIZE - 1);
+        const int   j  = std::min(static_cast<int>(v), GRID - 2);
+        const float fy = v - static_cast<float>(j);
+        alignas(32) float ex[8] = {}, ey[8] = {};
+        for (int i = 0; i < GRID; ++i) {
+            ex[i] = gx[j][i] + fy * (gx[j + 1][i] - gx[j][i]);
+            ey[i] = gy[j][i] + fy * (gy[j + 1][i] - gy[j][i]);
+        }
+        const float dy  = static_cast<float>(y) - CTR;
+        const float bx  =  sn * dy + CTR - tx;        // termes constants de la ligne
+        const float by  =  cs * dy + CTR - ty;
+
+#if defined(RN_AVX2)
+        const __m256 vex = _mm256_load_ps(ex), vey = _mm256_load_ps(ey);
+        const __m256 lo  = _mm256_set1_ps(-1.f), hi = _mm256_set1_ps(float(IMG_SIZE));
+        const __m256 one = _mm256_set1_ps(1.f);
+        const __m256i pw = _mm256_set1_epi32(PW);
+        for (int x0 = 0; x0 < ROW; x0 += 8) {
+            const __m256i ci = _mm256_load_si256(reinterpret_cast<const __m256i*>(&COLS.i[x0]));
+            const __m256  cf = _mm256_load_ps(&COLS.f[x0]);
+            const __m256i c1 = _mm256_add_epi32(ci, _mm256_set1_epi32(1));
+            const __m256  ux = _mm256_add_ps(_mm256_permutevar8x32_ps(vex, ci),
+                                 _mm256_mul_ps(cf, _mm256_sub_ps(_mm256_permutevar8x32_ps(vex, c1),
+                                                                 _mm256_permutevar8x32_ps(vex, ci))));
+            const __m256  uy = _mm256_add_ps(_mm256_permutevar8x32_ps(vey, ci),
+                                 _mm256_mul_ps(cf, _mm256_sub_ps(_mm256_permutevar8x32_ps(vey, c1),
+                                                                 _mm256_permutevar8x32_ps(vey, ci))));
+            const __m256 dx = _mm256_sub_ps(
+                _mm256_add_ps(_mm256_set1_ps(float(x0)), _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7)),
+                _mm256_set1_ps(CTR));
+
+            __m256 sx = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(cs), dx),
+                                                    _mm256_set1_ps(bx)), ux);
+            __m256 sy = _mm256_add_ps(_mm256_sub_ps(_mm256_set1_ps(by),
+                                                    _mm256_mul_ps(_mm256_set1_ps(sn), dx)), uy);
+            sx = _mm256_min_ps(_mm256_max_ps(sx, lo), hi);
+            sy = _mm256_min_ps(_mm256_max_ps(sy, lo), hi);
+
+            const __m256 fx0 = _mm256_floor_ps(sx), fy0 = _mm256_floor_ps(sy);
+            const __m256 wx  = _mm256_sub_ps(sx, fx0), wy = _mm256_sub_ps(sy, fy0);
+            const __m256i base = _mm256_add_epi32(
+                _mm256_mullo_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(fy0), _mm256_set1_epi32(1)), pw),
+                _mm256_add_epi32(_mm256_cvtps_epi32(fx0), _mm256_set1_epi32(1)));
+
+            const __m256 p00 = _mm256_i32gather_ps(pad,     base, 4);
+            const __m256 p01 = _mm256_i32gather_ps(pad + 1, base, 4);
+            const __m256 p10 = _mm256_i32gather_ps(pad + PW,     base, 4);
+            const __m256 p11 = _mm256_i32gather_ps(pad + PW + 1, base, 4);
+
+            const __m256 top = _mm256_add_ps(_mm256_mul_ps(p00, _mm256_sub_ps(one, wx)), _mm256_mul_ps(p01, wx));
+            const __m256 bot = _mm256_add_ps(_mm256_mul_ps(p10, _mm256_sub_ps(one, wx)), _mm256_mul_ps(p11, wx));
+            _mm256_store_ps(&row[x0], _mm256_add_ps(_mm256_mul_ps(top, _mm256_sub_ps(one, wy)),
+                                                    _mm256_mul_ps(bot, wy)));
+        }
+#elif defined(RN_SSE2)
+        /* 4 voies : ni gather, ni floor, ni permutation en SSE2 — champ
+           et indices par voie, plancher par troncature corrigée (exact) */
+        const __m128 lo  = _mm_set1_ps(-1.f), hi = _mm_set1_ps(float(IMG_SIZE));
+        const __m128 one = _mm_set1_ps(1.f);
+        for (int x0 = 0; x0 < ROW; x0 += 4) {
+            const int* ci = &COLS.i[x0];
+            const __m128 cf  = _mm_load_ps(&COLS.f[x0]);
+            const __m128 ex0 = _mm_setr_ps(ex[ci[0]], ex[ci[1]], ex[ci[2]], ex[ci[3]]);
+            const __m128 ex1 = _mm_setr_ps(ex[ci[0] + 1], ex[ci[1] + 1], ex[ci[2] + 1], ex[ci[3] + 1]);
+            const __m128 ey0 = _mm_setr_ps(ey[ci[0]], ey[ci[1]], ey[ci[2]], ey[ci[3]]);
+            const __m128 ey1 = _mm_setr_ps(ey[ci[0] + 1], ey[ci[1] + 1], ey[ci[2] + 1], ey[ci[3] + 1]);
+            const __m128 ux  = _mm_add_ps(ex0, _mm_mul_ps(cf, _mm_sub_ps(ex1, ex0)));
+            const __m128 uy  = _mm_add_ps(ey0, _mm_mul_ps(cf, _mm_sub_ps(ey1, ey0)));
+            const __m128 dx  = _mm_sub_ps(
+                _mm_add_ps(_mm_set1_ps(float(x0)), _mm_setr_ps(0, 1, 2, 3)), _mm_set1_ps(CTR));
+
+            __m128 sx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(cs), dx), _mm_set1_ps(bx)), ux);
+            __m128 sy = _mm_add_ps(_mm_sub_ps(_mm_set1_ps(by), _mm_mul_ps(_mm_set1_ps(sn), dx)), uy);
+            sx = _mm_min_ps(_mm_max_ps(sx, lo), hi);
+            sy = _mm_min_ps(_mm_max_ps(sy, lo), hi);
+
+            __m128 fx0 = _mm_cvtepi32_ps(_mm_cvttps_epi32(sx));
+            __m128 fy0 = _mm_cvtepi32_ps(_mm_cvttps_epi32(sy));
+            fx0 = _mm_sub_ps(fx0, _mm_and_ps(_mm_cmpgt_ps(fx0, sx), one));
+            fy0 = _mm_sub_ps(fy0, _mm_and_ps(_mm_cmpgt_ps(fy0, sy), one));
+            const __m128 wx = _mm_sub_ps(sx, fx0), wy = _mm_sub_ps(sy, fy0);
+
+            alignas(16) int ix[4], iy[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(ix), _mm_cvttps_epi32(fx0));
+            _mm_store_si128(reinterpret_cast<__m128i*>(iy), _mm_cvttps_epi32(fy0));
+            alignas(16) float v00[4], v01[4], v10[4], v11[4];
+            for (int k = 0; k < 4; ++k) {
+                const float* q = &pad[(iy[k] + 1) * PW + ix[k] + 1];
+                v00[k] = q[0];  v01[k] = q[1];
+                v10[k] = q[PW]; v11[k] = q[PW + 1];
+            }
+
+            const __m128 top = _mm_add_ps(_mm_mul_ps(_mm_load_ps(v00), _mm_sub_ps(one, wx)),
+                                          _mm_mul_ps(_mm_load_ps(v01), wx));
+            const __m128 bot = _mm_add_ps(_mm_mul_ps(_mm_load_ps(v10), _mm_sub_ps(one, wx)),
+                                          _mm_mul_ps(_mm_load_ps(v11), wx));
+            _mm_store_ps(&row[x0], _mm_add_ps(_mm_mul_ps(top, _mm_sub_ps(one, wy)),
+                                              _mm_mul_ps(bot, wy)));
+        }
+#else
+        for (int x = 0; x < IMG_SIZE; ++x) {
+            const int   ci = COLS.i[x];
+            const float cf = COLS.f[x];
+            const float ux = ex[ci] + cf * (ex[ci + 1] - ex[ci]);
+            const float uy = ey[ci] + cf * (ey[ci + 1] - ey[ci]);
+            const float dx = static_cast<float>(x) - CTR;
+
+            float sx = cs * dx + bx + ux;
+            float sy = by - sn * dx + uy;
+            sx = std::min(std::max(sx, -1.f), float(IMG_SIZE));
+            sy = std::min(std::max(sy, -1.f), float(IMG_SIZE));
+
+            const float fx0 = std::floor(sx), fy0 = std::floor(sy);
+            const float wx = sx - fx0, wy = sy - fy0;
+            const float* q = &pad[(static_cast<int>(fy0) + 1) * PW + static_cast<int>(fx0) + 1];
+
+            const float top = q[0]  * (1.f - wx) + q[1]      * wx;
+            const float bot = q[PW] * (1.f - wx) + q[PW + 1] * wx;
+            row[x] = top * (1.f - wy) + bot * wy;
+        }
+#endif
+        std::copy_n(row, IMG_SIZE, &dst[y * IMG_SIZE]);
+    }
+}
+
+/* ───────── AugmentPipeline ─────────────────────────────────────── */
+AugmentPipeline::AugmentPipeline(const Images& X, const Labels& Y,
+                                 const AugmentParams& p, uint64_t seed,
+                                 int workers, int depth)
+    : X_(X), Y_(Y), p_(p), seed_(seed), depth_(std::max(1, depth)),
+      slots_(depth_), ready_(depth_, 0)
+{
+    for (int w = 0; w < std::max(1, workers); ++w)
+        workers_.emplace_back(&AugmentPipeline::worker_loop, this);
+}
+
+AugmentPipeline::~AugmentPipeline()
+{
+    {
+        std::lock_guard<std::mutex> lk(m_);
+        stop_ = true;
+    }
+    cv_work_.notify_all();
+    for (std::thread& t : workers_) t.join();
+}
+
+void AugmentPipeline::start_epoch(int epoch, const std::vector<int>& order,
+                                  int batch_size)
+{
+    std::unique_lock<std::mutex> lk(m_);
+
+    /* on abandonne les lots non consommés de l'époque précédente */
+    next_claim_ = n_batches_;
+    cv_ready_.wait(lk, [&] { return busy_ == 0; });
+    std::fill(ready_.begin(), ready_.end(), 0);
+
+    epoch_      = epoch;
+    order_      = order;
+    batch_size_ = batch_size;
+    n_batches_  = static_cast<int>((order_.size() + batch_size - 1) / batch_size);
+    next_claim_ = 0;
+    next_take_  = 0;
+    cv_work_.notify_all();
+}
+
+bool AugmentPipeline::next(Batch& out)
+{
+    std::unique_lock<std::mutex> lk(m_);
+    if (next_take_ >= n_batches_) return false;
+
+    const int slot = next_take_ % depth_;
+    cv_ready_.wait(lk, [&] { return ready_[slot] != 0; });
+
+    std::swap(out, slots_[slot]);          // l'ancien tampon de `out` est recyclé
+    ready_[slot] = 0;
+    ++next_take_;
+    cv_work_.notify_all();
+    return true;
+}
+
+void AugmentPipeline::worker_loop()
+{
+    std::unique_lock<std::mutex> lk(m_);
+    for (;;) {
+        cv_work_.wait(lk, [&] {
+            return stop_ || (next_claim_ < n_batches_ &&
+                             next_claim_ < next_take_ + depth_);
+        });
+        if (stop_) return;
+
+        const int b = next_claim_++;
+        ++busy_;
+        const int ep    = epoch_;
+        const int begin = b * batch_size_;
+        const int end   = std::min(begin + batch_size_, static_cast<int>(order_.size()));
+        Batch& out      = slots_[b % depth_];  // slot libre : lot b - depth_ consommé
+        lk.unlock();
+
+        /* ---- production hors verrou ---- */
+        const int n = end - begin;
+        out.X.resize(n); out.Y.resize(n); out.idx.resize(n);
+        for (int k = 0; k < n; ++k) {
+            const int s = order_[begin + k];
+            augment_image(X_[s], out.X[k], p_, seed_, ep, s);
+            out.Y[k]   = Y_[s];
+            out.idx[k] = k;
+        }
+
+        lk.lock();
+        ready_[b % depth_] = 1;
+        --busy_;
+        cv_ready_.notify_all();
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include "tensor.h"
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* ───────── Paramètres d'augmentation ───────────────────────────── */
+struct AugmentParams {
+    float max_shift   = 2.0f;    // translation max (pixels)
+    float max_rot_deg = 10.0f;   // rotation max (degrés)
+    float elastic     = 1.5f;    // amplitude max de la distorsion (pixels)
+};
+
+/*  Transforme une image 28×28 : rotation + translation + champ élastique
+ *  lisse (grille 4×4 interpolée), rééchantillonnage bilinéaire.
+ *  Les paramètres tirés ne dépendent que de (seed, epoch, sample) :
+ *  même tirage quel que soit le thread ou l'ordre. Les pixels, eux,
+ *  peuvent varier aux derniers bits d'une plateforme à l'autre
+ *  (std::cos / std::sin, contraction en FMA, chemin AVX2 / SSE2 / scalaire).
+ */
+void augment_image(const Tensor& src, Tensor& dst,
+                   const AugmentParams& p,
+                   uint64_t seed, int epoch, uint64_t sample);
+
+/* ───────── Étage d'augmentation en arrière-plan ────────────────── */
+/*  Des threads producteurs préparent les mini-lots d'une époque dans
+ *  l'ordre donné par `order`, au plus `depth` lots d'avance, pendant
+ *  que le thread appelant entraîne sur les lots précédents.
+ */
+class AugmentPipeline {
+public:
+    AugmentPipeline(const Images& X, const Labels& Y,
+                    const AugmentParams& p, uint64_t seed,
+                    int workers = 1, int depth = 4);
+    ~AugmentPipeline();
+
+    AugmentPipeline(const AugmentPipeline&)            = delete;
+    AugmentPipeline& operator=(const AugmentPipeline&) = delete;
+
+    void start_epoch(int epoch, const std::vector<int>& order, int batch_size);
+    bool next(Batch& out);                             // false : fin d'époque
+
+private:
+    void worker_loop();
+
+    const Images&   X_;
+    const Labels&   Y_;
+    AugmentParams   p_;
+    uint64_t        seed_;
+    int             depth_;
+
+    std::mutex              m_;
+    std::condition_variable cv_work_, cv_ready_;
+    std::vector<std::thread> workers_;
+    bool stop_ = false;
+
+    /* état de l'époque courante (protégé par m_) */
+    int              epoch_ = 0, batch_size_ = 0, n_batches_ = 0;
+    std::vector<int> order_;
+    int              next_claim_ = 0;                   // prochain lot à produire
+    int              next_take_  = 0;                   // prochain lot à consommer
+    int              busy_       = 0;                   // lots en cours de production
+    std::vector<Batch> slots_;                          // anneau de `depth_` lots
+    std::vector<char>  ready_;
+};
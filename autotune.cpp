@@ -0,0 +1,257 @@
+#include "autotune.h"
+#include "cnn.h"
+#include "denseNN.h"
+#include "simd.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <random>
+#include <sstream>
+#include <vector>
+
+#if defined(_MSC_VER)
+  #include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+  #include <cpuid.h>
+#endif
+
+/* ───────── Identification de l'hôte ───────────────────────────── */
+std::string cpu_model()
+{
+    std::string name;
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+    unsigned regs[12] = {};
+    for (unsigned leaf = 0; leaf < 3; ++leaf) {
+  #if defined(_MSC_VER)
+        int r[4];
+        __cpuid(r, static_cast<int>(0x80000002u + leaf));
+        std::memcpy(&regs[leaf * 4], r, sizeof r);
+  #else
+        __get_cpuid(0x80000002u + leaf, &regs[leaf * 4], &regs[leaf * 4 + 1],
+                    &regs[leaf * 4 + 2], &regs[leaf * 4 + 3]);
+  #endif
+    }
+    name.assign(reinterpret_cast<const char*>(regs), sizeof regs);
+    name = name.c_str();                                 // coupe au premier '\0'
+#endif
+    /* espaces superflus ; '|' et tabulations réservés au cache */
+    std::string out;
+    for (char c : name) {
+        if (c == '|' || c == '\t') c = ' ';
+        if (c == ' ' && (out.empty() || out.back() == ' ')) continue;
+        out += c;
+    }
+    while (!out.empty() && out.back() == ' ') out.pop_back();
+    return out.empty() ? "inconnu" : out;
+}
+
+static const char* isa()
+{
+#if defined(RN_AVX2)
+    return "avx2";
+#elif defined(RN_SSE2)
+    return "sse2";
+#else
+    return "scalaire";
+#endif
+}
+
+/* ───────── Cache sur disque ────────────────────────────────────── */
+/*  Une ligne par entrée : clé <TAB> valeur. */
+class TuneCache {
+public:
+    explicit TuneCache(std::string path) : path_(std::move(path))
+    {
+        std::ifstream f(path_);
+        for (std::string line; std::getline(f, line); ) {
+            const std::size_t tab = line.find('\t');
+            if (tab != std::string::npos) map_[line.substr(0, tab)] = line.substr(tab + 1);
+        }
+    }
+
+    bool find(const std::string& key, std::string& value) const
+    {
+        const auto it = map_.find(key);
+        if (it == map_.end()) return false;
+        value = it->second;
+        return true;
+    }
+
+    void put(const std::string& key, const std::string& value) { map_[key] = value; dirty_ = true; }
+
+    void save() const
+    {
+        if (!dirty_) return;
+        std::ofstream f(path_, std::ios::trunc);
+        for (const auto& kv : map_) f << kv.first << '\t' << kv.second << '\n';
+    }
+
+private:
+    std::string                        path_;
+    std::map<std::string, std::string> map_;
+    bool                               dirty_ = false;
+};
+
+static std::string make_key(const std::string& op, const std::string& shape)
+{
+    std::ostringstream k;
+    k << cpu_model() << '|' << isa() << '|' << ThreadPool::instance().size()
+      << "t|" << op << '|' << shape;
+    return k.str();
+}
+
+/* ───────── Mesure ──────────────────────────────────────────────── */
+/* secondes par appel de f : répétitions calibrées à ~2 ms, meilleur de 5 */
+static double time_per_call(const std::function<void()>& f)
+{
+    using Clock = std::chrono::steady_clock;
+    f();                                                 // échauffement
+    int reps = 1;
+    for (;;) {
+        const auto t0 = Clock::now();
+        for (int r = 0; r < reps; ++r) f();
+        if (std::chrono::duration<double>(Clock::now() - t0).count() > 2e-3 || reps >= 1 << 16) break;
+        reps *= 2;
+    }
+    double best = 1e30;
+    for (int trial = 0; trial < 5; ++trial) {
+        const auto t0 = Clock::now();
+        for (int r = 0; r < reps; ++r) f();
+        best = std::min(best, std::chrono::duration<double>(Clock::now() - t0).count() / reps);
+    }
+    return best;
+}
+
+/* 0 (heuristique), 1 (en ligne), 2, 4, … ≤ min(items, 2 × threads) */
+static std::vector<int> task_candidates(int items)
+{
+    const int T = ThreadPool::instance().size();
+    std::vector<int> c = { 0 };
+    if (T == 1) return c;                                // tout s'exécute en ligne
+    for (int t = 1; t <= std::min(items, 2 * T); t *= 2) c.push_back(t);
+    if (T <= items && std::find(c.begin(), c.end(), T) == c.end()) c.push_back(T);
+    return c;
+}
+
+static Tensor random_tensor(std::size_t n, std::mt19937& g)
+{
+    std::uniform_real_distribution<float> U(-1.f, 1.f);
+    Tensor t(n);
+    for (float& v : t) v = U(g);
+    return t;
+}
+
+/* valeur de tranches lue dans le cache : entier de 0 à 4096, sinon
+   l'entrée est ignorée (cache corrompu ou édité) et la couche re-mesurée */
+static bool parse_tasks(const std::string& s, int& tasks)
+{
+    if (s.empty() || s.size() > 4) return false;
+    tasks = 0;
+    for (char c : s) {
+        if (c < '0' || c > '9') return false;
+        tasks = tasks * 10 + (c - '0');
+    }
+    return tasks <= 4096;
+}
+
+/* nombre de tranches d'une couche dense : cache, sinon mesure */
+static void tune_dense(Dense& layer, TuneCache& cache, TuneStats& st)
+{
+    const std::string key = make_key("dense", std::to_string(layer.in_dim()) + "x" +
+                                              std::to_string(layer.out_dim()));
+    std::string v;
+    int tasks;
+    if (cache.find(key, v) && parse_tasks(v, tasks)) {
+        layer.set_tasks(tasks);
+        ++st.cached;
+        return;
+    }
+
+    std::mt19937 g(1);
+    const Tensor x  = random_tensor(layer.in_dim(), g);
+    const Tensor gy = random_tensor(layer.out_dim(), g);
+    Dense probe = layer;                                 // copie : le modèle reste intact
+
+    int best = 0;
+    double best_s = 1e30;
+    for (int t : task_candidates(layer.out_dim() / Dense::PANEL + 1)) {
+        probe.set_tasks(t);
+        const double s = time_per_call([&] { probe.forward(x); probe.backward(gy); });
+        if (s < best_s) { best_s = s; best = t; }
+    }
+    layer.set_tasks(best);
+    cache.put(key, std::to_string(best));
+    ++st.measured;
+}
+
+/* ───────── Entrées publiques ───────────────────────────────────── */
+TuneStats autotune(CNN& net, const std::string& cache_path, bool tune_layout)
+{
+    TuneCache cache(cache_path);
+    TuneStats st;
+
+    /* conv (+ pool, qui suit la même disposition) ; disposition imposée
+       => clé propre à cette disposition, seules les tranches sont mesurées */
+    ConvLayer& conv = net.conv();
+    const char* op = tune_layout                     ? "conv3x3"
+                   : net.layout() == Layout::HWC     ? "conv3x3/HWC"
+                                                     : "conv3x3/CHW";
+    const std::string key = make_key(op, std::to_string(conv.in_channels()) + "x" +
+                                         std::to_string(conv.out_channels()) + "@" +
+                                         std::to_string(IMG_SIZE));
+    std::string v;
+    Layout layout = net.layout();
+    int    tasks  = 0;
+    const bool hit = cache.find(key, v) && v.size() > 4 && v[3] == ':' &&
+                     (v.compare(0, 3, "HWC") == 0 || v.compare(0, 3, "CHW") == 0) &&
+                     parse_tasks(v.substr(4), tasks);
+    if (hit) {
+        if (tune_layout) layout = v.compare(0, 3, "HWC") == 0 ? Layout::HWC : Layout::CHW;
+        ++st.cached;
+    }
+    else {
+        std::mt19937 g(1);
+        const Tensor x  = random_tensor(static_cast<std::size_t>(conv.in_channels()) * IMG_SIZE * IMG_SIZE, g);
+        const Tensor gp = random_tensor(static_cast<std::size_t>(conv.out_channels()) * IMG_SIZE * IMG_SIZE / 4, g);
+
+        double best_s = 1e30;
+        tasks = 0;
+        for (Layout l : { Layout::CHW, Layout::HWC }) {
+            if (!tune_layout && l != net.layout()) continue;
+            ConvLayer probe = conv;
+            probe.set_layout(l);
+            ReLU    relu;
+            MaxPool pool(l);
+            for (int t : task_candidates(IMG_SIZE)) {
+                probe.set_tasks(t);
+                const double s = time_per_call([&] {
+                    pool.forward(relu.forward(probe.forward(x)));
+                    probe.backward(relu.backward(pool.backward(gp)));
+                });
+                if (s < best_s) { best_s = s; layout = l; tasks = t; }
+            }
+        }
+        cache.put(key, std::string(layout == Layout::HWC ? "HWC" : "CHW") + ":" + std::to_string(tasks));
+        ++st.measured;
+    }
+    net.set_layout(layout);
+    net.conv().set_tasks(tasks);
+
+    tune_dense(net.fc(), cache, st);
+    cache.save();
+    return st;
+}
+
+TuneStats autotune(DenseNN& net, const std::string& cache_path, bool)
+{
+    TuneCache cache(cache_path);
+    TuneStats st;
+    for (int i = 0; i < 4; ++i) tune_dense(net.layer(i), cache, st);
+    cache.save();
+    return st;
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <string>
+
+class CNN;
+class DenseNN;
+
+/* ───────── Autotuner des noyaux ────────────────────────────────── */
+/*  Pour chaque couche du modèle, mesure les variantes disponibles :
+ *    - ConvLayer : disposition CHW / HWC (appliquée au modèle entier
+ *      par CNN::set_layout) × nombre de tranches parallèles ;
+ *    - Dense     : nombre de tranches parallèles (0 = heuristique,
+ *      1 = en ligne, 2, 4, … jusqu'au double des threads du pool).
+ *  Mesure = forward + backward d'une copie de la couche (le modèle
+ *  n'est pas touché), meilleur de 5 essais.
+ *
+ *  La disposition n'est mesurée que si `tune_layout` ; sinon celle du
+ *  modèle est conservée et seules les tranches sont réglées.
+ *
+ *  Les gagnants sont écrits dans `cache_path`, une ligne par clé
+ *  « modèle CPU | jeu d'instructions | threads | opération | forme » ;
+ *  aux lancements suivants ils sont relus sans aucune mesure. Une
+ *  entrée illisible (cache corrompu ou édité) est re-mesurée et
+ *  réécrite ; un cache absent est reconstruit.
+ */
+struct TuneStats {
+    int measured = 0;          // couches mesurées
+    int cached   = 0;          // couches réglées depuis le cache
+};
+
+TuneStats autotune(CNN&     net, const std::string& cache_path, bool tune_layout = false);
+TuneStats autotune(DenseNN& net, const std::string& cache_path, bool tune_layout = false);  // sans disposition
+
+/* nom du processeur (cpuid), « inconnu » ailleurs */
+std::string cpu_model();
@@ -0,0 +1,167 @@
+/*  Banc d'essai : l'étage d'augmentation suit-il CNN::train_batch ?
+ *
+ *  g++ -std=c++17 -O2 -mavx2 -pthread -I.. bench_augment.cpp \
+ *      ../augment.cpp ../cnn.cpp ../idx_stream.cpp ../layers.cpp ../pipeline.cpp \
+ *      ../thread_pool.cpp -o bench_augment
+ *
+ *  ./bench_augment [images.gz labels.gz]
+ *
+ *  Mesure (données synthétiques, aucun fichier MNIST requis) :
+ *    1. débit brut de augment_image (1 thread)
+ *    2. débit de train_batch seul
+ *    3. une époque complète via AugmentPipeline : temps passé par le
+ *       thread d'entraînement à attendre un lot (=> goulot si > 0)
+ *    4. même chose par IdxStream (chemin de main) : décodage gzip,
+ *       mélange, puis augmentation ; débit du flux seul et attente.
+ *       Fragment synthétique en blocs stockés (inflate le moins
+ *       coûteux) ou, si donnés, de vrais fichiers IDX compressés.
+ */
+#include "augment.h"
+#include "cnn.h"
+#include "idx_stream.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <numeric>
+#include <random>
+#include <string>
+
+using Clock = std::chrono::steady_clock;
+
+static double seconds(Clock::time_point a, Clock::time_point b)
+{
+    return std::chrono::duration<double>(b - a).count();
+}
+
+static void le32(std::vector<uint8_t>& o, uint32_t v)
+{
+    for (int k = 0; k < 4; ++k) o.push_back(static_cast<uint8_t>(v >> (8 * k)));
+}
+
+/* fichier IDX dans un membre gzip en blocs stockés */
+static void save_idx_gz(const std::string& path, uint32_t magic,
+                        const std::vector<uint32_t>& dims, const std::vector<uint8_t>& data)
+{
+    std::vector<uint8_t> raw = { 0, 0, static_cast<uint8_t>(magic >> 8), static_cast<uint8_t>(dims.size()) };
+    for (uint32_t d : dims)
+        for (int k = 3; k >= 0; --k) raw.push_back(static_cast<uint8_t>(d >> (8 * k)));
+    raw.insert(raw.end(), data.begin(), data.end());
+
+    uint32_t crc = ~0u;
+    for (uint8_t b : raw) {
+        crc ^= b;
+        for (int k = 0; k < 8; ++k) crc = crc & 1 ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+    }
+    std::vector<uint8_t> o = { 0x1F, 0x8B, 8, 0, 0, 0, 0, 0, 0, 0xFF };
+    for (std::size_t pos = 0; pos < raw.size(); ) {
+        const std::size_t len = std::min<std::size_t>(65535, raw.size() - pos);
+        o.push_back(pos + len == raw.size() ? 1 : 0);
+        o.push_back(len & 0xFF);  o.push_back(len >> 8);
+        o.push_back(~len & 0xFF); o.push_back((~len >> 8) & 0xFF);
+        o.insert(o.end(), raw.begin() + pos, raw.begin() + pos + len);
+        pos += len;
+    }
+    le32(o, ~crc);
+    le32(o, static_cast<uint32_t>(raw.size()));
+    std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(o.data()),
+                                                static_cast<std::streamsize>(o.size()));
+}
+
+int main(int argc, char** argv)
+{
+    constexpr int N = 4096, BATCH = 32;
+
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<float> U(0.f, 1.f);
+    Images X(N, Tensor(IMG_SIZE * IMG_SIZE));
+    Labels Y(N);
+    for (int i = 0; i < N; ++i) {
+        for (float& v : X[i]) v = U(gen) < 0.8f ? 0.f : U(gen);
+        Y[i] = static_cast<Label>(i % NUM_CLASSES);
+    }
+    AugmentParams p;
+
+    /* --- 1. augmentation seule --- */
+    Tensor out;
+    auto t0 = Clock::now();
+    for (int i = 0; i < N; ++i) augment_image(X[i], out, p, 42u, 1, i);
+    const double aug_ips = N / seconds(t0, Clock::now());
+
+    /* --- 2. entraînement seul --- */
+    CNN net(0.01f, gen);
+    std::vector<int> idx(N);
+    std::iota(idx.begin(), idx.end(), 0);
+    t0 = Clock::now();
+    for (int pos = 0; pos < N; pos += BATCH) {
+        std::vector<int> b(idx.begin() + pos, idx.begin() + pos + BATCH);
+        net.train_batch(X, Y, b, BATCH);
+    }
+    const double train_ips = N / seconds(t0, Clock::now());
+
+    /* --- 3. époque avec l'étage en arrière-plan --- */
+    AugmentPipeline pipe(X, Y, p, 42u);
+    double wait_s = 0.0;
+    t0 = Clock::now();
+    pipe.start_epoch(1, idx, BATCH);
+    for (;;) {
+        Batch b;
+        const auto w0 = Clock::now();
+        if (!pipe.next(b)) break;
+        wait_s += seconds(w0, Clock::now());
+        net.train_batch(b.X, b.Y, b.idx, static_cast<int>(b.idx.size()));
+    }
+    const double epoch_s = seconds(t0, Clock::now());
+
+    /* --- 4. IdxStream : gzip + mélange + augmentation --- */
+    IdxShard shard{ "bench_augment_images.gz", "bench_augment_labels.gz" };
+    const bool synthetic = argc < 3;
+    if (synthetic) {
+        std::vector<uint8_t> pix(static_cast<std::size_t>(N) * IMG_SIZE * IMG_SIZE);
+        for (std::size_t i = 0; i < pix.size(); ++i)
+            pix[i] = static_cast<uint8_t>(X[i / (IMG_SIZE * IMG_SIZE)][i % (IMG_SIZE * IMG_SIZE)] * 255.f);
+        save_idx_gz(shard.images, 0x803, { N, IMG_SIZE, IMG_SIZE }, pix);
+        save_idx_gz(shard.labels, 0x801, { N }, std::vector<uint8_t>(Y.begin(), Y.end()));
+    }
+    else shard = { argv[1], argv[2] };
+
+    IdxStream stream({ shard }, BATCH, 4096, 42u, &p);
+    int streamed = 0;
+    t0 = Clock::now();
+    stream.start_epoch(1);
+    for (Batch b; stream.next(b); ) streamed += static_cast<int>(b.X.size());
+    const double stream_ips = streamed / seconds(t0, Clock::now());
+
+    double stream_wait_s = 0.0, first_s = 0.0;            // premier lot : remplissage du mélange
+    int trained = 0;
+    t0 = Clock::now();
+    stream.start_epoch(2);
+    for (;;) {
+        Batch b;
+        const auto w0 = Clock::now();
+        if (!stream.next(b)) break;
+        (trained == 0 ? first_s : stream_wait_s) += seconds(w0, Clock::now());
+        net.train_batch(b.X, b.Y, b.idx, static_cast<int>(b.idx.size()));
+        if ((trained += static_cast<int>(b.X.size())) >= N) break;   // vrais fichiers : N images
+    }
+    const double stream_epoch_s = seconds(t0, Clock::now());
+    if (synthetic) {
+        std::remove(shard.images.c_str());
+        std::remove(shard.labels.c_str());
+    }
+
+    std::printf("augment_image      : %10.0f img/s (1 thread)\n", aug_ips);
+    std::printf("train_batch        : %10.0f img/s\n", train_ips);
+    std::printf("marge              : %10.1fx\n", aug_ips / train_ips);
+    std::printf("époque pipeline    : %10.3f s, attente lots %.4f s (%.2f%%)\n",
+                epoch_s, wait_s, 100.0 * wait_s / epoch_s);
+    std::printf("IdxStream seul     : %10.0f img/s (%s), marge %.1fx\n", stream_ips,
+                synthetic ? "gzip stocké" : "fichiers donnés", stream_ips / train_ips);
+    std::printf("époque IdxStream   : %10.3f s, premier lot %.4f s, attente ensuite %.4f s (%.2f%%)\n",
+                stream_epoch_s, first_s, stream_wait_s, 100.0 * stream_wait_s / stream_epoch_s);
+
+    const bool ok = aug_ips > train_ips && stream_ips > train_ips;
+    std::printf("%s\n", ok ? "OK : l'augmentation n'est pas le goulot"
+                           : "GOULOT : augmenter le nombre de workers");
+    return ok ? 0 : 1;
+}
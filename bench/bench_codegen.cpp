@@ -0,0 +1,131 @@
+/*  Parité et latence du code d'inférence généré (emit_cpp)
+ *
+ *  1. génération (modèles déterministes : 1 thread, graine 42) :
+ *     g++ -std=c++17 -O2 -mavx2 -pthread -I.. bench_codegen.cpp ../codegen.cpp \
+ *         ../cnn.cpp ../denseNN.cpp ../layers.cpp ../pipeline.cpp ../thread_pool.cpp -o bench_codegen
+ *     ./bench_codegen            => cnn_infer.cpp (HWC), cnn_chw_infer.cpp, dense_infer.cpp
+ *
+ *  2. vérification, avec les fichiers générés inclus :
+ *     g++ -std=c++17 -O2 -mavx2 -pthread -I.. -I. -DRN_GENERATED bench_codegen.cpp \
+ *         ../codegen.cpp ../cnn.cpp ../denseNN.cpp ../layers.cpp ../pipeline.cpp \
+ *         ../thread_pool.cpp -o bench_codegen_chk
+ *     ./bench_codegen_chk        => écart max contre CNN::forward (HWC et CHW) /
+ *                                   DenseNN::forward, latences ; code de sortie 1
+ *                                   si écart > 1e-4
+ */
+#include "cnn.h"
+#include "codegen.h"
+#include "denseNN.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <numeric>
+#include <random>
+
+#if defined(RN_GENERATED)
+  #include "cnn_infer.cpp"
+  #include "cnn_chw_infer.cpp"
+  #include "dense_infer.cpp"
+#endif
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int N = 1024, BATCH = 32;
+
+/* images uint8 synthétiques (chiffres au centre, bord nul) et leur version float */
+static void make_data(std::vector<uint8_t>& raw, Images& X, Labels& Y)
+{
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<int> B(0, 255);
+    raw.assign(static_cast<std::size_t>(N) * IMG_SIZE * IMG_SIZE, 0);
+    X.assign(N, Tensor(IMG_SIZE * IMG_SIZE));
+    Y.resize(N);
+    for (int i = 0; i < N; ++i) {
+        for (int y = 4; y < 24; ++y)
+            for (int x = 4; x < 24; ++x)
+                if (B(gen) < 80) raw[(static_cast<std::size_t>(i) * IMG_SIZE + y) * IMG_SIZE + x] = static_cast<uint8_t>(B(gen));
+        for (int k = 0; k < IMG_SIZE * IMG_SIZE; ++k)
+            X[i][k] = raw[static_cast<std::size_t>(i) * IMG_SIZE * IMG_SIZE + k] / 255.0f;
+        Y[i] = static_cast<Label>(i % NUM_CLASSES);
+    }
+}
+
+/* quelques mini-lots pour sortir des poids initiaux */
+template <class Net>
+static void warm_up(Net& net, const Images& X, const Labels& Y)
+{
+    std::vector<int> idx(BATCH);
+    for (int pos = 0; pos + BATCH <= N; pos += BATCH) {
+        std::iota(idx.begin(), idx.end(), pos);
+        net.train_batch(X, Y, idx, BATCH);
+    }
+}
+
+#if defined(RN_GENERATED)
+template <class Net, class Gen>
+static float check(const char* name, Net& net, Gen gen,
+                   const std::vector<uint8_t>& raw, const Images& X)
+{
+    float diff = 0.f;
+    float out[NUM_CLASSES];
+    for (int i = 0; i < N; ++i) {
+        gen(&raw[static_cast<std::size_t>(i) * IMG_SIZE * IMG_SIZE], out);
+        const Tensor ref = net.forward(X[i]);
+        for (int k = 0; k < NUM_CLASSES; ++k) diff = std::max(diff, std::fabs(out[k] - ref[k]));
+    }
+
+    float sink = 0.f;
+    auto t0 = Clock::now();
+    for (int i = 0; i < N; ++i) sink += net.infer(X[i])[0];
+    const double us_ref = 1e6 * std::chrono::duration<double>(Clock::now() - t0).count() / N;
+    t0 = Clock::now();
+    for (int i = 0; i < N; ++i) {
+        gen(&raw[static_cast<std::size_t>(i) * IMG_SIZE * IMG_SIZE], out);
+        sink += out[0];
+    }
+    const double us_gen = 1e6 * std::chrono::duration<double>(Clock::now() - t0).count() / N;
+
+    std::printf("%-8s écart max %.2e   infer %8.2f us   généré %8.2f us   (%.1fx)%s\n",
+                name, diff, us_ref, us_gen, us_ref / us_gen, sink == 12345.f ? " " : "");
+    return diff;
+}
+#endif
+
+int main()
+{
+    ThreadPool::configure({ 1, false, {} });     // mêmes poids aux deux étapes
+
+    std::vector<uint8_t> raw;
+    Images X;
+    Labels Y;
+    make_data(raw, X, Y);
+
+    std::mt19937 g1(42), g2(42), g3(42);
+    CNN     cnn(0.01f, g1, Layout::HWC);
+    CNN     chw(0.01f, g3, Layout::CHW);         // fc indexée dans l'autre ordre
+    DenseNN dnn(0.1f, g2);
+    warm_up(cnn, X, Y);
+    warm_up(chw, X, Y);
+    warm_up(dnn, X, Y);
+
+#if defined(RN_GENERATED)
+    const float d1 = check("CNN HWC", cnn, cnn_infer,     raw, X);
+    const float d3 = check("CNN CHW", chw, cnn_chw_infer, raw, X);
+    const float d2 = check("DenseNN", dnn, dense_infer,   raw, X);
+    const bool  ok = d1 < 1e-4f && d2 < 1e-4f && d3 < 1e-4f;
+    std::printf("%s\n", ok ? "OK : parité du code généré" : "ÉCART : code généré divergent");
+    return ok ? 0 : 1;
+#else
+    std::ofstream f1("cnn_infer.cpp"), f2("dense_infer.cpp"), f3("cnn_chw_infer.cpp");
+    emit_cpp(cnn, f1, "cnn_infer");
+    emit_cpp(chw, f3, "cnn_chw_infer");
+    emit_cpp(dnn, f2, "dense_infer");
+    std::printf("cnn_infer.cpp, cnn_chw_infer.cpp, dense_infer.cpp écrits\n");
+    return f1 && f2 && f3 ? 0 : 1;
+#endif
+}
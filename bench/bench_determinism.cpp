@@ -0,0 +1,128 @@
+/*  Banc d'essai : mode reproductible (set_deterministic)
+ *
+ *  g++ -std=c++17 -O2 -mavx2 -pthread -I.. bench_determinism.cpp \
+ *      ../cnn.cpp ../denseNN.cpp ../layers.cpp ../pipeline.cpp ../thread_pool.cpp -o bench_determinism
+ *
+ *  Mesure (données synthétiques, aucun fichier MNIST requis), pour le
+ *  CNN en CHW et en HWC et pour le DenseNN :
+ *    1. quelques mini-lots entraînés avec 1, 2, 3, 4 et 8 threads ;
+ *       empreinte des pertes et des sorties sur un lot témoin, en mode
+ *       par défaut (pour information) puis reproductible (exigé égal)
+ *    2. débit de train_batch avec le pool par défaut, mode par défaut
+ *       contre reproductible : surcoût exigé < 10 %
+ */
+#include "cnn.h"
+#include "denseNN.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+#include <random>
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int N = 512, BATCH = 32;
+
+/* empreinte FNV-1a des bits d'une suite de floats */
+static uint64_t fnv(uint64_t h, const Tensor& v)
+{
+    for (float f : v) {
+        uint32_t b;
+        std::memcpy(&b, &f, sizeof b);
+        for (int k = 0; k < 4; ++k) { h ^= (b >> (8 * k)) & 0xffu; h *= 1099511628211ull; }
+    }
+    return h;
+}
+
+template <class Net>
+static uint64_t fingerprint(Net& net, const Images& X, const Labels& Y)
+{
+    std::vector<int> idx(BATCH);
+    Tensor losses;
+    for (int pos = 0; pos < N; pos += BATCH) {
+        std::iota(idx.begin(), idx.end(), pos);
+        losses.push_back(net.train_batch(X, Y, idx, BATCH));
+    }
+    uint64_t h = fnv(1469598103934665603ull, losses);
+    for (int i = 0; i < 64; ++i) h = fnv(h, net.infer(X[i]));
+    return h;
+}
+
+/* images par seconde, meilleur de 5 passes */
+template <class Net>
+static double throughput(Net& net, const Images& X, const Labels& Y)
+{
+    std::vector<int> idx(BATCH);
+    double best = 0.0;
+    for (int trial = 0; trial < 5; ++trial) {
+        const auto t0 = Clock::now();
+        for (int pos = 0; pos < N; pos += BATCH) {
+            std::iota(idx.begin(), idx.end(), pos);
+            net.train_batch(X, Y, idx, BATCH);
+        }
+        best = std::max(best, N / std::chrono::duration<double>(Clock::now() - t0).count());
+    }
+    return best;
+}
+
+/* renvoie false si le mode reproductible n'est pas reproductible ou trop lent */
+template <class Net, class Make>
+static bool check(const char* name, Make make, const Images& X, const Labels& Y)
+{
+    const int threads[] = { 1, 2, 3, 4, 8 };
+    bool same = true;
+    for (bool det : { false, true }) {
+        set_deterministic(det);
+        std::printf("%-9s %-14s", name, det ? "reproductible" : "défaut");
+        uint64_t ref = 0;
+        bool all = true;
+        for (int t : threads) {
+            ThreadPool::configure({ t, false, {} });
+            Net net = make();
+            const uint64_t h = fingerprint(net, X, Y);
+            if (t == threads[0]) ref = h;
+            all = all && h == ref;
+            std::printf(" %d:%08x", t, static_cast<unsigned>(h));
+        }
+        std::printf("  %s\n", all ? "identiques" : "DIFFÉRENTES");
+        if (det) same = all;
+    }
+
+    ThreadPool::configure({});
+    double ips[2];
+    for (bool det : { false, true }) {
+        set_deterministic(det);
+        Net net = make();
+        ips[det] = throughput(net, X, Y);
+    }
+    set_deterministic(false);
+    const double cost = 100.0 * (ips[0] - ips[1]) / ips[0];
+    std::printf("%-9s débit %.0f -> %.0f img/s (%d threads), surcoût %.1f%%\n\n",
+                name, ips[0], ips[1], ThreadPool::instance().size(), cost);
+    return same && cost < 10.0;
+}
+
+int main()
+{
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<float> U(0.f, 1.f);
+    Images X(N, Tensor(IMG_SIZE * IMG_SIZE));
+    Labels Y(N);
+    for (int i = 0; i < N; ++i) {
+        for (float& v : X[i]) v = U(gen) < 0.8f ? 0.f : U(gen);
+        Y[i] = static_cast<Label>(i % NUM_CLASSES);
+    }
+
+    bool ok = true;
+    ok &= check<CNN>("CNN CHW", [] { std::mt19937 g(42); return CNN(0.01f, g, Layout::CHW); }, X, Y);
+    ok &= check<CNN>("CNN HWC", [] { std::mt19937 g(42); return CNN(0.01f, g, Layout::HWC); }, X, Y);
+    ok &= check<DenseNN>("DenseNN", [] { std::mt19937 g(42); return DenseNN(0.01f, g); }, X, Y);
+
+    std::printf("%s\n", ok ? "OK : bit à bit quel que soit le nombre de threads, surcoût < 10 %"
+                           : "ÉCHEC");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,150 @@
+/*  Banc d'essai : fragments IDX compressés altérés
+ *
+ *  g++ -std=c++17 -O2 -pthread -I.. bench_idx_stream.cpp \
+ *      ../augment.cpp ../idx_stream.cpp ../mnist_loader.cpp -o bench_idx_stream
+ *
+ *  Écrit de petits fragments .gz (blocs stockés, aucune dépendance) dans
+ *  le répertoire courant, puis vérifie, via IdxStream et load_images :
+ *    1. un fragment intact est relu à l'identique
+ *    2. CRC32 faux, octet de données inversé, ISIZE faux, octets après
+ *       le membre gzip : chaque altération lève une erreur
+ *    3. une étiquette >= NUM_CLASSES (gzip valide) lève une erreur
+ */
+#include "idx_stream.h"
+#include "mnist_loader.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+constexpr int N = 100;                          // 78 400 octets : deux blocs stockés
+
+static uint32_t crc32(const std::vector<uint8_t>& v)
+{
+    uint32_t c = ~0u;
+    for (uint8_t b : v) {
+        c ^= b;
+        for (int k = 0; k < 8; ++k) c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+    }
+    return ~c;
+}
+
+static void le32(std::vector<uint8_t>& o, uint32_t v)
+{
+    for (int k = 0; k < 4; ++k) o.push_back(static_cast<uint8_t>(v >> (8 * k)));
+}
+
+/* membre gzip en blocs stockés ; `payload` : position du premier octet de données */
+static std::vector<uint8_t> gzip_stored(const std::vector<uint8_t>& raw, std::size_t& payload)
+{
+    std::vector<uint8_t> o = { 0x1F, 0x8B, 8, 0, 0, 0, 0, 0, 0, 0xFF };
+    payload = 0;
+    for (std::size_t pos = 0; pos < raw.size(); ) {
+        const std::size_t len = std::min<std::size_t>(65535, raw.size() - pos);
+        o.push_back(pos + len == raw.size() ? 1 : 0);
+        o.push_back(len & 0xFF);  o.push_back(len >> 8);
+        o.push_back(~len & 0xFF); o.push_back((~len >> 8) & 0xFF);
+        if (pos == 0) payload = o.size();
+        o.insert(o.end(), raw.begin() + pos, raw.begin() + pos + len);
+        pos += len;
+    }
+    le32(o, crc32(raw));
+    le32(o, static_cast<uint32_t>(raw.size()));
+    return o;
+}
+
+static std::vector<uint8_t> idx(uint32_t magic, std::vector<uint32_t> dims, const std::vector<uint8_t>& data)
+{
+    std::vector<uint8_t> o = { 0, 0, static_cast<uint8_t>(magic >> 8), static_cast<uint8_t>(dims.size()) };
+    for (uint32_t d : dims)
+        for (int k = 3; k >= 0; --k) o.push_back(static_cast<uint8_t>(d >> (8 * k)));
+    o.insert(o.end(), data.begin(), data.end());
+    return o;
+}
+
+static void save(const std::string& path, const std::vector<uint8_t>& v)
+{
+    std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(v.data()),
+                                                static_cast<std::streamsize>(v.size()));
+}
+
+/* "" si tout passe, sinon le message d'erreur */
+static std::string attempt(const std::function<void()>& f)
+{
+    try { f(); return ""; }
+    catch (const std::exception& e) { return e.what(); }
+}
+
+static std::string stream_all(const std::string& images, const std::string& labels, Images* out = nullptr)
+{
+    return attempt([&] {
+        IdxStream s({ { images, labels } }, 32, 1, 1);  // tampon de 1 : ordre d'origine
+        s.start_epoch(1);
+        for (Batch b; s.next(b); )
+            if (out) out->insert(out->end(), b.X.begin(), b.X.end());
+    });
+}
+
+int main()
+{
+    std::vector<uint8_t> pix(static_cast<std::size_t>(N) * IMG_SIZE * IMG_SIZE), lab(N);
+    for (std::size_t i = 0; i < pix.size(); ++i) pix[i] = static_cast<uint8_t>(i * 7 + i / 13);
+    for (int i = 0; i < N; ++i) lab[i] = static_cast<uint8_t>(i % NUM_CLASSES);
+
+    std::size_t payload, lpay;
+    const std::vector<uint8_t> good = gzip_stored(idx(0x803, { N, IMG_SIZE, IMG_SIZE }, pix), payload);
+    save("bench_idx_labels.gz", gzip_stored(idx(0x801, { N }, lab), lpay));
+    save("bench_idx_good.gz", good);
+
+    bool ok = true;
+
+    /* 1. fragment intact */
+    Images got;
+    std::string err = stream_all("bench_idx_good.gz", "bench_idx_labels.gz", &got);
+    bool same = err.empty() && got.size() == static_cast<std::size_t>(N);
+    for (std::size_t i = 0; same && i < got.size(); ++i)
+        for (int j = 0; j < IMG_SIZE * IMG_SIZE; ++j)
+            same = same && got[i][j] == pix[i * IMG_SIZE * IMG_SIZE + j] / 255.0f;
+    ok = ok && same;
+    std::printf("%-22s %s\n", "intact", same ? "relu à l'identique" : ("ÉCHEC " + err).c_str());
+
+    /* 2. altérations : chacune doit échouer par les deux chemins */
+    struct Case { const char* name; std::function<void(std::vector<uint8_t>&)> alter; };
+    const Case cases[] = {
+        { "CRC32 faux",        [](std::vector<uint8_t>& v) { v[v.size() - 8] ^= 0x01; } },
+        { "octet inversé",     [&](std::vector<uint8_t>& v) { v[payload + 4000] ^= 0xFF; } },
+        { "ISIZE faux",        [](std::vector<uint8_t>& v) { v[v.size() - 4] ^= 0x01; } },
+        { "octets en trop",    [](std::vector<uint8_t>& v) { v.push_back(0x42); } },
+    };
+    for (const Case& c : cases) {
+        std::vector<uint8_t> bad = good;
+        c.alter(bad);
+        save("bench_idx_bad.gz", bad);
+        const std::string e1 = stream_all("bench_idx_bad.gz", "bench_idx_labels.gz");
+        const std::string e2 = attempt([] { load_images("bench_idx_bad.gz"); });
+        const bool caught = !e1.empty() && !e2.empty();
+        ok = ok && caught;
+        std::printf("%-22s IdxStream: %-24s load_images: %s\n", c.name,
+                    e1.empty() ? "ACCEPTÉ" : e1.c_str(), e2.empty() ? "ACCEPTÉ" : e2.c_str());
+    }
+
+    /* 3. étiquette hors bornes dans un fragment par ailleurs valide */
+    std::vector<uint8_t> wild = lab;
+    wild[N / 2] = NUM_CLASSES;
+    save("bench_idx_bad.gz", gzip_stored(idx(0x801, { N }, wild), lpay));
+    const std::string e1 = stream_all("bench_idx_good.gz", "bench_idx_bad.gz");
+    const std::string e2 = attempt([] { load_labels("bench_idx_bad.gz"); });
+    ok = ok && !e1.empty() && !e2.empty();
+    std::printf("%-22s IdxStream: %-24s load_labels: %s\n", "étiquette = 10",
+                e1.empty() ? "ACCEPTÉ" : e1.c_str(), e2.empty() ? "ACCEPTÉ" : e2.c_str());
+
+    std::remove("bench_idx_good.gz");
+    std::remove("bench_idx_bad.gz");
+    std::remove("bench_idx_labels.gz");
+    std::printf("%s\n", ok ? "OK : toute altération est détectée" : "ÉCHEC");
+    return ok ? 0 : 1;
+}
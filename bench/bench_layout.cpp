@@ -0,0 +1,97 @@
+/*  Banc d'essai : activations CHW contre HWC (conv vectorisée sur oc)
+ *
+ *  g++ -std=c++17 -O2 -mavx2 -pthread -I.. bench_layout.cpp \
+ *      ../cnn.cpp ../layers.cpp ../pipeline.cpp ../thread_pool.cpp -o bench_layout
+ *
+ *  Mesure (données synthétiques, aucun fichier MNIST requis) :
+ *    1. conv forward + backward seuls, pour quelques (inC, outC)
+ *    2. débit de CNN::train_batch dans les deux dispositions
+ *    3. parité : même graine => mêmes sorties aux arrondis près
+ */
+#include "cnn.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <numeric>
+#include <random>
+
+using Clock = std::chrono::steady_clock;
+
+static double seconds(Clock::time_point a, Clock::time_point b)
+{
+    return std::chrono::duration<double>(b - a).count();
+}
+
+/* µs par forward + backward d'une conv 28×28 */
+static double time_conv(int inC, int outC, Layout layout)
+{
+    std::mt19937 g(1);
+    std::uniform_real_distribution<float> U(-1.f, 1.f);
+    ConvLayer conv(inC, outC, 3, g, layout);
+    Tensor in(static_cast<std::size_t>(inC) * IMG_SIZE * IMG_SIZE), gr(static_cast<std::size_t>(outC) * IMG_SIZE * IMG_SIZE);
+    for (float& v : in) v = U(g);
+    for (float& v : gr) v = U(g);
+
+    const int reps = std::max(20, 20000 / (inC * outC));
+    float sink = 0.f;
+    const auto t0 = Clock::now();
+    for (int r = 0; r < reps; ++r) {
+        sink += conv.forward(in)[0];
+        sink += conv.backward(gr)[0];
+    }
+    conv.apply_gradients(reps, 0.f);
+    const double us = 1e6 * seconds(t0, Clock::now()) / reps;
+    return sink == 12345.f ? 0.0 : us;          // garde `sink` vivant
+}
+
+int main()
+{
+    constexpr int N = 2048, BATCH = 32;
+
+    std::printf("conv 3x3 28x28 (forward + backward, us)\n");
+    std::printf("  inC outC        CHW        HWC   gain\n");
+    const int shapes[][2] = { { 1, 8 }, { 8, 8 }, { 8, 16 }, { 16, 32 } };
+    for (const auto& s : shapes) {
+        const double chw = time_conv(s[0], s[1], Layout::CHW);
+        const double hwc = time_conv(s[0], s[1], Layout::HWC);
+        std::printf("  %3d %4d %10.1f %10.1f %5.2fx\n", s[0], s[1], chw, hwc, chw / hwc);
+    }
+
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<float> U(0.f, 1.f);
+    Images X(N, Tensor(IMG_SIZE * IMG_SIZE));
+    Labels Y(N);
+    for (int i = 0; i < N; ++i) {
+        for (float& v : X[i]) v = U(gen) < 0.8f ? 0.f : U(gen);
+        Y[i] = static_cast<Label>(i % NUM_CLASSES);
+    }
+    std::vector<int> idx(N);
+    std::iota(idx.begin(), idx.end(), 0);
+
+    double ips[2];
+    float  diff = 0.f;
+    {
+        std::mt19937 g0(7), g1(7);
+        CNN nets[2] = { CNN(0.01f, g0, Layout::CHW), CNN(0.01f, g1, Layout::HWC) };
+        for (int l = 0; l < 2; ++l) {
+            const auto t0 = Clock::now();
+            for (int pos = 0; pos < N; pos += BATCH) {
+                std::vector<int> b(idx.begin() + pos, idx.begin() + pos + BATCH);
+                nets[l].train_batch(X, Y, b, BATCH);
+            }
+            ips[l] = N / seconds(t0, Clock::now());
+        }
+        for (int i = 0; i < 64; ++i) {
+            const Tensor a = nets[0].infer(X[i]), b = nets[1].infer(X[i]);
+            for (int k = 0; k < NUM_CLASSES; ++k) diff = std::max(diff, std::fabs(a[k] - b[k]));
+        }
+    }
+
+    std::printf("train_batch CHW    : %10.0f img/s\n", ips[0]);
+    std::printf("train_batch HWC    : %10.0f img/s (%.2fx)\n", ips[1], ips[1] / ips[0]);
+    std::printf("écart max logits   : %10.2e\n", diff);
+    std::printf("%s\n", diff < 1e-3f ? "OK : dispositions équivalentes" : "ÉCART : dispositions divergentes");
+    return diff < 1e-3f ? 0 : 1;
+}
@@ -0,0 +1,79 @@
+/*  Banc d'essai : CNN::train_batch séquentiel contre pipeliné
+ *
+ *  g++ -std=c++17 -O2 -mavx2 -pthread -I.. bench_pipeline.cpp \
+ *      ../cnn.cpp ../layers.cpp ../pipeline.cpp ../thread_pool.cpp -o bench_pipeline
+ *
+ *  Mesure (données synthétiques, aucun fichier MNIST requis), dans les
+ *  deux dispositions, en mode reproductible :
+ *    1. débit de train_batch, étages en séquence puis en pipeline
+ *    2. parité : mêmes pertes et mêmes sorties, bit à bit
+ *  Le pipeline occupe trois threads (plus le pool) : sans trois cœurs
+ *  libres, il ne peut pas être plus rapide.
+ */
+#include "cnn.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <thread>
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int N = 2048, BATCH = 32;
+
+struct Run {
+    double ips;                 // images / s
+    Tensor out;                 // pertes des lots + sorties d'un lot témoin
+};
+
+static Run train(Layout layout, bool pipelined, const Images& X, const Labels& Y)
+{
+    std::mt19937 g(42);
+    CNN net(0.01f, g, layout);
+    net.set_pipelined(pipelined);
+
+    Run r;
+    std::vector<int> idx(BATCH);
+    const auto t0 = Clock::now();
+    for (int pos = 0; pos < N; pos += BATCH) {
+        std::iota(idx.begin(), idx.end(), pos);
+        r.out.push_back(net.train_batch(X, Y, idx, BATCH));
+    }
+    r.ips = N / std::chrono::duration<double>(Clock::now() - t0).count();
+    for (int i = 0; i < 16; ++i) {
+        const Tensor o = net.infer(X[i]);
+        r.out.insert(r.out.end(), o.begin(), o.end());
+    }
+    return r;
+}
+
+int main()
+{
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<float> U(0.f, 1.f);
+    Images X(N, Tensor(IMG_SIZE * IMG_SIZE));
+    Labels Y(N);
+    for (int i = 0; i < N; ++i) {
+        for (float& v : X[i]) v = U(gen) < 0.8f ? 0.f : U(gen);
+        Y[i] = static_cast<Label>(i % NUM_CLASSES);
+    }
+    set_deterministic(true);
+
+    bool same = true;
+    for (Layout layout : { Layout::CHW, Layout::HWC }) {
+        const char* name = layout == Layout::HWC ? "HWC" : "CHW";
+        const Run seq  = train(layout, false, X, Y);
+        const Run pipe = train(layout, true,  X, Y);
+        const bool eq  = seq.out == pipe.out;
+        same = same && eq;
+        std::printf("%s  séquentiel %8.0f img/s   pipeliné %8.0f img/s   x%.2f   %s\n",
+                    name, seq.ips, pipe.ips, pipe.ips / seq.ips,
+                    eq ? "bit à bit identiques" : "DIFFÉRENTS");
+    }
+    std::printf("cœurs : %u, pool : %d threads\n",
+                std::thread::hardware_concurrency(), ThreadPool::instance().size());
+    return same ? 0 : 1;
+}
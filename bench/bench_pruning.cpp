@@ -0,0 +1,67 @@
+/*  Banc d'essai : équilibre de l'élagage Dense::prune entre sorties
+ *
+ *  g++ -std=c++17 -O2 -mavx2 -pthread -I.. bench_pruning.cpp \
+ *      ../denseNN.cpp ../layers.cpp ../thread_pool.cpp -o bench_pruning
+ *
+ *  Vérifie (poids aléatoires, aucun fichier MNIST requis) :
+ *    1. pour plusieurs formes, dont des sorties non multiples de
+ *       Dense::PANEL (dernier panneau partiel), et plusieurs taux :
+ *       chaque sortie garde le même nombre d'entrées, à 1 près
+ *    2. DenseNN::prune laisse la couche de sortie dense
+ *    3. coût d'une inférence dense contre élaguée
+ */
+#include "denseNN.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+
+/* entrées conservées (poids non nuls) par sortie : min et max */
+static void kept_range(const Dense& d, int& lo, int& hi)
+{
+    lo = d.in_dim(); hi = 0;
+    for (int o = 0; o < d.out_dim(); ++o) {
+        int kept = 0;
+        for (int i = 0; i < d.in_dim(); ++i) kept += d.weight(o, i) != 0.f;
+        lo = std::min(lo, kept);
+        hi = std::max(hi, kept);
+    }
+}
+
+int main()
+{
+    struct Shape { int in, out; };
+    const Shape shapes[] = { { 1568, 10 }, { 784, 256 }, { 256, 128 }, { 64, 10 }, { 100, 13 } };
+    const float levels[] = { 0.5f, 0.8f, 0.9f, 0.95f };
+
+    bool ok = true;
+    std::printf("%-10s %6s %9s %9s %9s %9s\n", "forme", "taux", "min", "max", "attendu", "MFLOP");
+    for (const Shape& s : shapes)
+        for (float sp : levels) {
+            std::mt19937 g(42);
+            Dense d(s.in, s.out, g);
+            d.prune(sp);
+            int lo, hi;
+            kept_range(d, lo, hi);
+            const int expect = s.in - static_cast<int>(sp * s.in + 0.5f);
+            const bool good = hi - lo <= 1 && lo >= expect - 1 && hi <= expect;
+            ok = ok && good;
+
+            char name[32];
+            std::snprintf(name, sizeof name, "%dx%d", s.in, s.out);
+            std::printf("%-10s %5.0f%% %9d %9d %9d %9.3f %s\n", name, 100.f * sp, lo, hi, expect,
+                        d.cost().flops * 1e-6, good ? "" : "DÉSÉQUILIBRÉ");
+        }
+
+    std::mt19937 g(42);
+    DenseNN net(0.01f, g);
+    net.prune(0.9f);
+    int lo, hi;
+    kept_range(net.layer(3), lo, hi);
+    const bool out_dense = lo == net.layer(3).in_dim() && hi == lo;
+    ok = ok && out_dense;
+    std::printf("DenseNN 90%% : couche de sortie %s\n", out_dense ? "dense" : "ÉLAGUÉE");
+
+    std::printf("%s\n", ok ? "OK : élagage équilibré entre sorties" : "ÉCHEC");
+    return ok ? 0 : 1;
+}
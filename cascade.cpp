@@ -0,0 +1,91 @@
+#include "cascade.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+
+float softmax_margin(const Tensor& z, int* arg)
+{
+    /* deux plus grands logits : p1 − p2 = (1 − e^(z2 − z1)) / Σ e^(z − z1) */
+    int i1 = 0;
+    for (int k = 1; k < static_cast<int>(z.size()); ++k)
+        if (z[k] > z[i1]) i1 = k;
+    float z2 = -INFINITY, sum = 0.f;
+    for (int k = 0; k < static_cast<int>(z.size()); ++k) {
+        sum += std::exp(z[k] - z[i1]);
+        if (k != i1) z2 = std::max(z2, z[k]);
+    }
+    if (arg) *arg = i1;
+    return (1.f - std::exp(z2 - z[i1])) / sum;
+}
+
+Cascade::Cascade(const DenseNN& fast, const CNN& slow, float threshold)
+    : fast_(fast), slow_(slow), threshold_(threshold)
+{}
+
+int Cascade::predict(const Tensor& img, bool* fell_back) const
+{
+    int cls;
+    const bool sure = softmax_margin(fast_.infer(img), &cls) >= threshold_;
+    if (fell_back) *fell_back = !sure;
+    return sure ? cls : slow_.predict(img);
+}
+
+/* ───────── Calibration ───────── */
+float calibrate_cascade(const DenseNN& fast, const CNN& slow,
+                        const Images& X, const Labels& Y,
+                        const std::vector<float>& thresholds,
+                        std::vector<CascadePoint>* points)
+{
+    using Clock = std::chrono::steady_clock;
+    if (X.empty()) throw std::runtime_error("calibrate_cascade : jeu de calibration vide");
+    if (Y.size() != X.size())
+        throw std::runtime_error("calibrate_cascade : images et étiquettes en nombre différent");
+    const std::size_t n = X.size();
+    std::vector<float> margin(n);
+    std::vector<int>   fast_cls(n), slow_cls(n);
+
+    auto t0 = Clock::now();
+    for (std::size_t i = 0; i < n; ++i) margin[i] = softmax_margin(fast.infer(X[i]), &fast_cls[i]);
+    const double us_fast = 1e6 * std::chrono::duration<double>(Clock::now() - t0).count() / n;
+
+    t0 = Clock::now();
+    for (std::size_t i = 0; i < n; ++i) slow_cls[i] = slow.predict(X[i]);
+    const double us_slow = 1e6 * std::chrono::duration<double>(Clock::now() - t0).count() / n;
+
+    int slow_ok = 0;
+    for (std::size_t i = 0; i < n; ++i) slow_ok += slow_cls[i] == Y[i];
+    const double slow_acc = 100.0 * slow_ok / n;
+
+    std::printf("DenseNN %.2f us/img   CNN %.2f us/img   CNN seul : %.2f%%\n",
+                us_fast, us_slow, slow_acc);
+    std::printf("%8s %9s %9s %9s %7s\n", "seuil", "test", "repli", "us/img", "gain");
+
+    float  best      = INFINITY;      // CNN seul, tant qu'aucun seuil ne fait mieux
+    double best_cost = us_slow;
+    for (float t : thresholds) {
+        int ok = 0;
+        std::size_t fb = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            const bool sure = margin[i] >= t;
+            fb += !sure;
+            ok += (sure ? fast_cls[i] : slow_cls[i]) == Y[i];
+        }
+        CascadePoint p{ t, 100.0 * ok / n, static_cast<double>(fb) / n, 0.0 };
+        p.mean_us = us_fast + p.fallback * us_slow;
+        if (points) points->push_back(p);
+
+        std::printf("%8.3f %8.2f%% %8.1f%% %9.2f %6.2fx\n",
+                    t, p.accuracy, 100.0 * p.fallback, p.mean_us, us_slow / p.mean_us);
+        if (ok >= slow_ok && p.mean_us < best_cost) { best = t; best_cost = p.mean_us; }
+    }
+
+    if (std::isfinite(best))
+        std::printf("seuil retenu : %.3f (%.2f us/img contre %.2f pour le CNN seul)\n",
+                    best, best_cost, us_slow);
+    else
+        std::printf("aucun seuil ne fait mieux que le CNN seul\n");
+    return best;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include "cnn.h"
+#include "denseNN.h"
+#include "tensor.h"
+#include <vector>
+
+/* ───────── Cascade DenseNN → CNN ───────────────────────────────── */
+/*  Le DenseNN (rapide) répond seul quand la marge de son soft-max
+ *  (p1 − p2, deux plus fortes probabilités) dépasse `threshold` ;
+ *  sinon le CNN (précis) tranche. threshold = 0 : DenseNN seul,
+ *  threshold > 1 : CNN seul. Les deux modèles sont lus en const :
+ *  predict est thread-safe.
+ */
+class Cascade {
+public:
+    Cascade(const DenseNN& fast, const CNN& slow, float threshold);
+
+    int   predict(const Tensor& img, bool* fell_back = nullptr) const;
+
+    float threshold() const  { return threshold_; }
+    void  set_threshold(float t) { threshold_ = t; }
+
+private:
+    const DenseNN& fast_;
+    const CNN&     slow_;
+    float          threshold_;
+};
+
+/* marge p1 − p2 du soft-max des logits ; `arg` reçoit l'argmax */
+float softmax_margin(const Tensor& logits, int* arg = nullptr);
+
+/* ───────── Calibration du seuil ───────── */
+struct CascadePoint {
+    float  threshold;
+    double accuracy;           // % sur le jeu évalué
+    double fallback;           // fraction d'images passées au CNN
+    double mean_us;            // coût moyen estimé par image
+};
+
+/*  Évalue une fois chaque modèle sur (X, Y) (prédictions, marges et
+ *  latences moyennes mesurées), puis en déduit, pour chaque seuil,
+ *  précision et coût moyen : t_dense + fallback × t_cnn.
+ *  Affiche le tableau et renvoie le seuil le moins coûteux dont la
+ *  précision égale au moins celle du CNN seul pour un coût inférieur
+ *  (+inf, soit le CNN seul, si aucun n'y parvient). Un jeu vide, ou
+ *  des étiquettes en nombre différent des images, lève
+ *  std::runtime_error.
+ */
+float calibrate_cascade(const DenseNN& fast, const CNN& slow,
+                        const Images& X, const Labels& Y,
+                        const std::vector<float>& thresholds,
+                        std::vector<CascadePoint>* points = nullptr);
@@ -1,16 +1,49 @@
 ﻿// cnn.cpp – implémentations
 #include "cnn.h"
+#include "pipeline.h"
 #include <algorithm>
 #include <cmath>
 
 /* ───────── constructor du modele ───────── */
-CNN::CNN(float lr, std::mt19937& g)
+CNN::CNN(float lr, std::mt19937& g, Layout layout)
     : conv_(1, 8, 3, g),
       relu_{},
       pool_{},
       fc_(8 * 14 * 14, 10, g),
       lr_(lr)
-{}
+{
+    set_layout(layout);
+}
+
+/* ───────── changement de disposition (entre deux mini-lots) ───────── */
+/*  conv et pool changent d'indexation ; l'entrée de la couche dense est
+    permutée pour que le modèle calcule toujours la même fonction. */
+void CNN::set_layout(Layout layout)
+{
+    if (layout == layout_) return;
+
+    /* CHW → HWC : entrée dense (y, x, c) = ancienne entrée (c, y, x) ;
+       HWC → CHW : la permutation inverse */
+    std::vector<int> src(8 * 14 * 14);
+    for (int y = 0; y < 14; ++y)
+        for (int x = 0; x < 14; ++x)
+            for (int c = 0; c < 8; ++c) {
+                const int chw = c * 14 * 14 + y * 14 + x, hwc = (y * 14 + x) * 8 + c;
+                if (layout == Layout::HWC) src[hwc] = chw;
+                else                       src[chw] = hwc;
+            }
+    fc_.permute_inputs(src);
+    conv_.set_layout(layout);
+    pool_.set_layout(layout);
+    layout_ = layout;
+}
+
+/* ───────── exécution pipelinée de train_batch ───────── */
+void CNN::set_pipelined(bool on)
+{
+    if (on && !pipe_) pipe_ = std::make_shared<TrainPipeline>();
+    if (!on)          pipe_.reset();
+}
 
 /* ───────── forward pass ───────── */
 Tensor CNN::forward(const Tensor& x)
@@ -21,6 +54,31 @@ Tensor CNN::forward(const Tensor& x)
                  conv_.forward(x))));
 }
 
+/* ───────── inference pass (const, aucun état modifié) ───────── */
+/*  Les couches n'écrivent aucun cache : plusieurs threads peuvent
+    interroger le même modèle simultanément, sans copie ni verrou. */
+Tensor CNN::infer(const Tensor& x) const
+{
+    return fc_.infer(
+             pool_.infer(
+               relu_.infer(
+                 conv_.infer(x))));
+}
+
+/* ───────── inference par lot ───────── */
+/*  conv → relu → pool image par image, puis la couche dense sur les
+    n vecteurs de caractéristiques empilés (poids lus une fois / 4 images) */
+Tensor CNN::infer_batch(const Images& X, std::size_t first, int n) const
+{
+    const std::size_t D = fc_.in_dim();
+    Tensor feat(n * D);
+    for (int j = 0; j < n; ++j) {
+        const Tensor f = pool_.infer(relu_.infer(conv_.infer(X[first + j])));
+        std::copy(f.begin(), f.end(), feat.begin() + j * D);
+    }
+    return fc_.infer_batch(feat, n);
+}
+
 /* ───────── single-sample (accumule grad) ───────── */
 float CNN::train_one(const Tensor& x, Label y)
 {
@@ -59,8 +117,11 @@ float CNN::train_batch(const Images& X, const Labels& Y,
                        int batch_sz)
 {
     float loss_sum = 0.f;
-    for (int i : batch_idx)
-        loss_sum += train_one(X[i], Y[i]);      // accumulate gradients
+    if (pipe_)
+        loss_sum = pipe_->run(*this, X, Y, batch_idx);
+    else
+        for (int i : batch_idx)
+            loss_sum += train_one(X[i], Y[i]);  // accumulate gradients
 
     /* ---- appliquer LES mêmes gradients une seule fois ---- */
     conv_.apply_gradients(batch_sz, lr_);
@@ -72,9 +133,9 @@ float CNN::train_batch(const Images& X, const Labels& Y,
 }
 
 /* ───────── inference ───────── */
-int CNN::predict(const Tensor& x)
+int CNN::predict(const Tensor& x) const
 {
-    const Tensor y = forward(x);
+    const Tensor y = infer(x);
     return static_cast<int>(
         std::distance(y.begin(),
                       std::max_element(y.begin(), y.end())));
@@ -1,22 +1,50 @@
 ﻿#pragma once
 #include "layers.h"
 #include "tensor.h"           // définit Tensor, Images, Labels, Label
+#include <memory>
 #include <random>
 #include <vector>
 
+class TrainPipeline;
+
 class CNN
 {
 public:
-    explicit CNN(float lr, std::mt19937& g);
+    /* layout : disposition des activations conv → pool. En HWC, la
+       couche dense est permutée pour rester équivalente au modèle CHW. */
+    CNN(float lr, std::mt19937& g, Layout layout = Layout::CHW);
 
     /* --- API --- */
-    Tensor forward    (const Tensor& img);                       // inference
+    Tensor forward    (const Tensor& img);                       // entraînement (caches)
+    Tensor infer      (const Tensor& img) const;                 // inférence, thread-safe
     float  train_one  (const Tensor& img, Label y);              // 1 image : accumule grad
     float  train_batch(const Images& X, const Labels& Y,         // applique grad 1×/lot
                        const std::vector<int>& batch_idx,
                        int batch_sz);
 
-    int    predict(const Tensor& img);
+    int    predict(const Tensor& img) const;                     // via infer()
+
+    /* n images X[first..first+n) : n lignes de NUM_CLASSES logits */
+    Tensor infer_batch(const Images& X, std::size_t first, int n) const;
+
+    /* élagage de la couche dense (voir Dense::prune) */
+    void      prune(float sparsity) { fc_.prune(sparsity); }
+    DenseCost dense_cost() const    { return fc_.cost(); }
+
+    /* lecture des couches (export, génération de code) */
+    const ConvLayer& conv() const { return conv_; }
+    const Dense&     fc()   const { return fc_; }
+    ConvLayer&       conv()       { return conv_; }
+    Dense&           fc()         { return fc_; }
+
+    Layout layout() const { return layout_; }
+    void   set_layout(Layout layout);            // modèle inchangé (fc permutée)
+
+    /* train_batch en trois étages concurrents (voir pipeline.h), mêmes
+       gradients. Les copies du modèle partagent le pipeline, qui ne
+       traite qu'un lot à la fois. */
+    void   set_pipelined(bool on);
+    bool   pipelined() const { return pipe_ != nullptr; }
 
 private:
     ConvLayer conv_;
@@ -24,4 +52,6 @@ private:
     MaxPool   pool_;
     Dense     fc_;
     float     lr_;               // taux d’apprentissage courant
+    Layout    layout_ = Layout::CHW;
+    std::shared_ptr<TrainPipeline> pipe_;
 };
@@ -0,0 +1,156 @@
+#include "codegen.h"
+#include "cnn.h"
+#include "denseNN.h"
+
+#include <cstdio>
+#include <stdexcept>
+#include <vector>
+
+/* ───────── Écriture des tableaux ───────────────────────────────── */
+static void emit_array(std::ostream& os, const char* name, const std::string& dims,
+                       const std::vector<float>& v)
+{
+    os << "alignas(32) constexpr float " << name << dims << " = {\n";
+    char buf[32];
+    for (std::size_t i = 0; i < v.size(); ++i) {
+        std::snprintf(buf, sizeof buf, "%.9ef", v[i]);
+        os << (i % 6 == 0 ? "    " : " ") << buf << (i + 1 < v.size() ? "," : "")
+           << (i % 6 == 5 || i + 1 == v.size() ? "\n" : "");
+    }
+    os << "};\n";
+}
+
+static int pad16(int n) { return (n + 15) / 16 * 16; }
+
+static void emit_header(std::ostream& os, const char* model, const std::string& fn)
+{
+    os << "/* Inférence " << model << " spécialisée : généré par emit_cpp (codegen.cpp),\n"
+          " * ne pas modifier. Entrée : image 28×28 uint8, sortie : 10 logits.\n"
+          " * Autonome, sans allocation, thread-safe. */\n"
+          "#include <cstdint>\n\n"
+          "void " << fn << "(const uint8_t img[784], float out[10]);\n\n"
+          "namespace " << fn << "_model {\n\n";
+}
+
+/* ───────── CNN : conv 3×3 (1→C) → ReLU → MaxPool 2×2 → Dense ───── */
+/*  Une seule passe sur les cellules de pooling : pour chacune, les 4
+    sorties de conv (C canaux, contigus) sont calculées, réduites par
+    max, passées par ReLU (max(0, ·) commute avec max) et versées
+    directement dans les accumulateurs de la couche dense. */
+void emit_cpp(const CNN& net, std::ostream& os, const std::string& fn)
+{
+    const ConvLayer& conv = net.conv();
+    const Dense&     fc   = net.fc();
+    const int C = conv.out_channels(), P = IMG_SIZE / 2, OUT = fc.out_dim(), OP = pad16(OUT);
+    if (conv.in_channels() != 1 || conv.kernel() != 3 || fc.in_dim() != C * P * P)
+        throw std::runtime_error("emit_cpp : topologie CNN non prise en charge");
+
+    /* conv : [tap][c] ; dense : [cellule][c][o], o complété à OP */
+    std::vector<float> cw(9 * C), cb(C), fw(static_cast<std::size_t>(P) * P * C * OP, 0.f), fb(OP, 0.f);
+    for (int c = 0; c < C; ++c) {
+        cb[c] = conv.bias(c);
+        for (int t = 0; t < 9; ++t) cw[t * C + c] = conv.weight(c, 0, t);
+    }
+    for (int cell = 0; cell < P * P; ++cell)
+        for (int c = 0; c < C; ++c) {
+            /* indice d'entrée de fc selon la disposition des activations */
+            const int i = conv.layout() == Layout::HWC ? cell * C + c : c * P * P + cell;
+            for (int o = 0; o < OUT; ++o)
+                fw[(static_cast<std::size_t>(cell) * C + c) * OP + o] = fc.weight(o, i);
+        }
+    for (int o = 0; o < OUT; ++o) fb[o] = fc.bias(o);
+
+    emit_header(os, "CNN", fn);
+    os << "constexpr int H = " << IMG_SIZE << ", HP = H + 2, P = " << P
+       << ", C = " << C << ", OUT = " << OUT << ", OP = " << OP << ";\n\n";
+    emit_array(os, "CONV_W", "[9 * C]", cw);
+    emit_array(os, "CONV_B", "[C]", cb);
+    emit_array(os, "FC_W", "[P * P * C * OP]", fw);
+    emit_array(os, "FC_B", "[OP]", fb);
+    os << "\n} // namespace " << fn << "_model\n\n"
+          "void " << fn << "(const uint8_t img[784], float out[10])\n"
+          "{\n"
+          "    using namespace " << fn << "_model;\n\n"
+          "    /* entrée normalisée, bordée de zéros (pad 1) */\n"
+          "    alignas(32) float x[HP * HP] = {};\n"
+          "    for (int y = 0; y < H; ++y)\n"
+          "        for (int xx = 0; xx < H; ++xx)\n"
+          "            x[(y + 1) * HP + xx + 1] = img[y * H + xx] / 255.0f;\n\n"
+          "    alignas(32) float acc[OP];\n"
+          "    for (int o = 0; o < OP; ++o) acc[o] = FC_B[o];\n\n"
+          "    for (int py = 0; py < P; ++py)\n"
+          "        for (int px = 0; px < P; ++px) {\n"
+          "            alignas(32) float pooled[C] = {};          // ReLU : plancher à 0\n"
+          "            for (int d = 0; d < 4; ++d) {\n"
+          "                const float* win = &x[(2 * py + d / 2) * HP + 2 * px + d % 2];\n"
+          "                alignas(32) float s[C];\n"
+          "                for (int c = 0; c < C; ++c) s[c] = CONV_B[c];\n"
+          "                for (int t = 0; t < 9; ++t) {\n"
+          "                    const float v = win[(t / 3) * HP + t % 3];\n"
+          "                    for (int c = 0; c < C; ++c) s[c] += v * CONV_W[t * C + c];\n"
+          "                }\n"
+          "                for (int c = 0; c < C; ++c) pooled[c] = s[c] > pooled[c] ? s[c] : pooled[c];\n"
+          "            }\n"
+          "            const float* w = &FC_W[(py * P + px) * C * OP];\n"
+          "            for (int c = 0; c < C; ++c)\n"
+          "                for (int o = 0; o < OP; ++o) acc[o] += pooled[c] * w[c * OP + o];\n"
+          "        }\n\n"
+          "    for (int o = 0; o < OUT; ++o) out[o] = acc[o];\n"
+          "}\n";
+}
+
+/* ───────── DenseNN : 4 couches denses, ReLU fusionnée ──────────── */
+/*  Poids rangés [entrée][sortie] (sortie complétée à 16) : chaque
+    entrée non nulle diffuse sa valeur sur une ligne contiguë. Les
+    entrées nulles (bord des chiffres MNIST, ReLU) sont sautées. */
+void emit_cpp(const DenseNN& net, std::ostream& os, const std::string& fn)
+{
+    constexpr int L = 4;
+    if (net.layer(0).in_dim() != IMG_SIZE * IMG_SIZE || net.layer(L - 1).out_dim() != NUM_CLASSES)
+        throw std::runtime_error("emit_cpp : topologie DenseNN non prise en charge");
+
+    emit_header(os, "DenseNN", fn);
+    for (int l = 0; l < L; ++l) {
+        const Dense& d = net.layer(l);
+        const int IN = d.in_dim(), OUT = d.out_dim(), OP = pad16(OUT);
+        if (l > 0 && IN != net.layer(l - 1).out_dim())
+            throw std::runtime_error("emit_cpp : dimensions DenseNN incohérentes");
+
+        std::vector<float> w(static_cast<std::size_t>(IN) * OP, 0.f), b(OP, 0.f);
+        for (int i = 0; i < IN; ++i)
+            for (int o = 0; o < OUT; ++o) w[static_cast<std::size_t>(i) * OP + o] = d.weight(o, i);
+        for (int o = 0; o < OUT; ++o) b[o] = d.bias(o);
+
+        const std::string n = std::to_string(l + 1);
+        os << "constexpr int IN" << n << " = " << IN << ", OUT" << n << " = " << OUT
+           << ", OP" << n << " = " << OP << ";\n";
+        emit_array(os, ("W" + n).c_str(), "[IN" + n + " * OP" + n + "]", w);
+        emit_array(os, ("B" + n).c_str(), "[OP" + n + "]", b);
+        os << "\n";
+    }
+    os << "template <int IN, int OP, bool RELU>\n"
+          "inline void dense(const float* x, const float* W, const float* B, float* y)\n"
+          "{\n"
+          "    for (int o = 0; o < OP; ++o) y[o] = B[o];\n"
+          "    for (int i = 0; i < IN; ++i) {\n"
+          "        const float v = x[i];\n"
+          "        if (v == 0.f) continue;\n"
+          "        for (int o = 0; o < OP; ++o) y[o] += v * W[i * OP + o];\n"
+          "    }\n"
+          "    if (RELU)\n"
+          "        for (int o = 0; o < OP; ++o) y[o] = y[o] > 0.f ? y[o] : 0.f;\n"
+          "}\n\n"
+          "} // namespace " << fn << "_model\n\n"
+          "void " << fn << "(const uint8_t img[784], float out[10])\n"
+          "{\n"
+          "    using namespace " << fn << "_model;\n\n"
+          "    alignas(32) float x[IN1];\n"
+          "    for (int i = 0; i < IN1; ++i) x[i] = img[i] / 255.0f;\n\n"
+          "    alignas(32) float h1[OP1], h2[OP2], h3[OP3], y[OP4];\n"
+          "    dense<IN1, OP1, true >(x,  W1, B1, h1);\n"
+          "    dense<IN2, OP2, true >(h1, W2, B2, h2);\n"
+          "    dense<IN3, OP3, true >(h2, W3, B3, h3);\n"
+          "    dense<IN4, OP4, false>(h3, W4, B4, y);\n\n"
+          "    for (int o = 0; o < OUT4; ++o) out[o] = y[o];\n"
+          "}\n";
+}
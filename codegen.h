@@ -0,0 +1,24 @@
+#pragma once
+#include <ostream>
+#include <string>
+
+class CNN;
+class DenseNN;
+
+/* ───────── Génération de code d'inférence (AOT) ────────────────── */
+/*  Écrit un fichier C++ autonome définissant
+ *
+ *      void <fn>(const uint8_t img[784], float out[10]);
+ *
+ *  pour le modèle entraîné : formes en constantes, poids figés dans des
+ *  tableaux constexpr alignés, couches fusionnées (conv → ReLU → pool
+ *  → dense en une passe pour le CNN). Aucune dépendance, aucune
+ *  allocation. L'image est normalisée comme load_images (÷ 255).
+ *
+ *  Les poids sont écrits en %.9e (relus à l'identique) et les sommes
+ *  suivent l'ordre des couches HWC : sorties identiques au bit près à
+ *  DenseNN::infer et à CNN::infer en HWC ; en CHW, seul l'ordre des
+ *  sommes de la couche dense diffère (écarts ~1e-7).
+ */
+void emit_cpp(const CNN&     net, std::ostream& os, const std::string& fn = "infer");
+void emit_cpp(const DenseNN& net, std::ostream& os, const std::string& fn = "infer");
@@ -0,0 +1,144 @@
+// denseNN.cpp – implémentations
+#include "denseNN.h"
+#include <algorithm>
+#include <cmath>
+
+/* ───────── constructor du modele ───────── */
+DenseNN::DenseNN(float lr, std::mt19937& g)
+    : layer1_(IMG_SIZE * IMG_SIZE, 256, g),
+      relu1_{},
+      layer2_(256, 128, g),
+      relu2_{},
+      layer3_(128, 64, g),
+      relu3_{},
+      layer4_(64, NUM_CLASSES, g),
+      lr_(lr)
+{}
+
+/* ───────── forward pass ───────── */
+Tensor DenseNN::forward(const Tensor& x)
+{
+    return layer4_.forward(
+             relu3_.forward(
+               layer3_.forward(
+                 relu2_.forward(
+                   layer2_.forward(
+                     relu1_.forward(
+                       layer1_.forward(x)))))));
+}
+
+/* ───────── inference pass (const, aucun état modifié) ───────── */
+Tensor DenseNN::infer(const Tensor& x) const
+{
+    return layer4_.infer(
+             relu3_.infer(
+               layer3_.infer(
+                 relu2_.infer(
+                   layer2_.infer(
+                     relu1_.infer(
+                       layer1_.infer(x)))))));
+}
+
+/* ───────── inference par lot ───────── */
+/*  Les activations de n images sont empilées (n lignes) : chaque couche
+    dense lit ses poids une fois pour 4 images. ReLU est élément par
+    élément, la forme du lot lui est indifférente. */
+Tensor DenseNN::infer_batch(const Images& X, std::size_t first, int n) const
+{
+    const std::size_t D = IMG_SIZE * IMG_SIZE;
+    Tensor a(n * D);
+    for (int j = 0; j < n; ++j)
+        std::copy(X[first + j].begin(), X[first + j].end(), a.begin() + j * D);
+
+    a = relu1_.infer(layer1_.infer_batch(a, n));
+    a = relu2_.infer(layer2_.infer_batch(a, n));
+    a = relu3_.infer(layer3_.infer_batch(a, n));
+    return layer4_.infer_batch(a, n);
+}
+
+/* ───────── single-sample (accumule grad) ───────── */
+float DenseNN::train_one(const Tensor& x, Label y)
+{
+    /* -------- forward + soft-max -------- */
+    Tensor logits = forward(x);
+
+    float maxv = *std::max_element(logits.begin(), logits.end());
+    Tensor p(logits.size());
+    float  sum = 0.f;
+    for (size_t i = 0; i < logits.size(); ++i) {
+        p[i] = std::exp(logits[i] - maxv);
+        sum += p[i];
+    }
+    for (float& v : p) v /= sum;
+
+    float loss = -std::log(std::max(1e-7f, p[y]));
+
+    /* -------- gradient -------- */
+    Tensor d_logits(p.size());
+    for (size_t i = 0; i < p.size(); ++i)
+        d_logits[i] = p[i] - (i == static_cast<size_t>(y) ? 1.f : 0.f);
+
+    Tensor d4 = layer4_.backward(d_logits);
+    Tensor d3 = layer3_.backward(relu3_.backward(d4));
+    Tensor d2 = layer2_.backward(relu2_.backward(d3));
+    layer1_.backward(relu1_.backward(d2));
+
+    return loss;
+}
+
+/* ───────── mini-batch training step ───────── */
+float DenseNN::train_batch(const Images& X, const Labels& Y,
+                           const std::vector<int>& batch_idx,
+                           int batch_sz)
+{
+    float loss_sum = 0.f;
+    for (int i : batch_idx)
+        loss_sum += train_one(X[i], Y[i]);      // accumulate gradients
+
+    layer1_.apply_gradients(batch_sz, lr_);
+    layer2_.apply_gradients(batch_sz, lr_);
+    layer3_.apply_gradients(batch_sz, lr_);
+    layer4_.apply_gradients(batch_sz, lr_);
+
+    return loss_sum / static_cast<float>(batch_sz);
+}
+
+/* ───────── élagage ───────── */
+/*  La couche de sortie (64 → 10) reste dense : elle pèse peu et chaque
+    bloc retiré y ampute directement les scores des classes. */
+void DenseNN::prune(float sparsity)
+{
+    layer1_.prune(sparsity);
+    layer2_.prune(sparsity);
+    layer3_.prune(sparsity);
+}
+
+DenseCost DenseNN::dense_cost() const
+{
+    DenseCost c = layer1_.cost();
+    c += layer2_.cost();
+    c += layer3_.cost();
+    c += layer4_.cost();
+    return c;
+}
+
+const Dense& DenseNN::layer(int i) const
+{
+    const Dense* layers[] = { &layer1_, &layer2_, &layer3_, &layer4_ };
+    return *layers[i];
+}
+
+Dense& DenseNN::layer(int i)
+{
+    Dense* layers[] = { &layer1_, &layer2_, &layer3_, &layer4_ };
+    return *layers[i];
+}
+
+/* ───────── inference ───────── */
+int DenseNN::predict(const Tensor& x) const
+{
+    const Tensor y = infer(x);
+    return static_cast<int>(
+        std::distance(y.begin(),
+                      std::max_element(y.begin(), y.end())));
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include "layers.h"
+#include "tensor.h"
+#include <random>
+#include <vector>
+
+/* ───────── Réseau tout connecté (784-256-128-64-10) ────────────── */
+/*  Même modèle que Version_FC, sur les couches du moteur : gradients
+ *  accumulés par mini-lot, inférence const et thread-safe.
+ */
+class DenseNN
+{
+public:
+    explicit DenseNN(float lr, std::mt19937& g);
+
+    /* --- API --- */
+    Tensor forward    (const Tensor& img);                       // entraînement (caches)
+    Tensor infer      (const Tensor& img) const;                 // inférence, thread-safe
+    float  train_one  (const Tensor& img, Label y);              // 1 image : accumule grad
+    float  train_batch(const Images& X, const Labels& Y,         // applique grad 1×/lot
+                       const std::vector<int>& batch_idx,
+                       int batch_sz);
+
+    int    predict(const Tensor& img) const;                     // via infer()
+
+    /* n images X[first..first+n) : n lignes de NUM_CLASSES logits */
+    Tensor infer_batch(const Images& X, std::size_t first, int n) const;
+
+    /* élagage des couches cachées (voir Dense::prune) ; sortie dense */
+    void      prune(float sparsity);
+    DenseCost dense_cost() const;
+
+    /* lecture des couches denses 0..3 (export, génération de code) */
+    const Dense& layer(int i) const;
+    Dense&       layer(int i);
+
+private:
+    Dense layer1_;    // entrée (IMG_SIZE*IMG_SIZE -> 256)
+    ReLU  relu1_;
+    Dense layer2_;    // cachée (256 -> 128)
+    ReLU  relu2_;
+    Dense layer3_;    // cachée (128 -> 64)
+    ReLU  relu3_;
+    Dense layer4_;    // sortie (64 -> 10)
+    float lr_;        // taux d'apprentissage
+};
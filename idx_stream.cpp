@@ -0,0 +1,568 @@
+#include "idx_stream.h"
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+
+/* ───────── ByteSource ──────────────────────────────────────────── */
+ByteSource::ByteSource(const std::string& path)
+    : f_(path, std::ios::binary), buf_(1 << 16)
+{
+    if (!f_) throw std::runtime_error("Cannot open " + path);
+}
+
+bool ByteSource::refill()
+{
+    f_.read(reinterpret_cast<char*>(buf_.data()), static_cast<std::streamsize>(buf_.size()));
+    len_ = static_cast<std::size_t>(f_.gcount());
+    pos_ = 0;
+    return len_ > 0;
+}
+
+int ByteSource::get()
+{
+    if (pos_ == len_ && !refill()) return -1;
+    return buf_[pos_++];
+}
+
+int ByteSource::peek()
+{
+    if (pos_ == len_ && !refill()) return -1;
+    return buf_[pos_];
+}
+
+std::size_t ByteSource::read(uint8_t* dst, std::size_t n)
+{
+    std::size_t got = 0;
+    while (got < n) {
+        if (pos_ == len_ && !refill()) break;
+        const std::size_t k = std::min(n - got, len_ - pos_);
+        std::memcpy(dst + got, &buf_[pos_], k);
+        pos_ += k; got += k;
+    }
+    return got;
+}
+
+/* ───────── GzipSource ──────────────────────────────────────────── */
+namespace {
+
+constexpr uint32_t WSIZE = 32768;                  // fenêtre deflate
+
+const short LBASE[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                          35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+const short LEXT[29]  = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                          3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+const short DBASE[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                          257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+                          8193, 12289, 16385, 24577 };
+const short DEXT[30]  = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                          7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+struct Crc32Table {
+    uint32_t t[256];
+    Crc32Table() {
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k) c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[n] = c;
+        }
+    }
+};
+const Crc32Table CRC;
+
+uint32_t crc32_update(uint32_t crc, const uint8_t* p, std::size_t n)
+{
+    crc = ~crc;
+    for (std::size_t i = 0; i < n; ++i) crc = CRC.t[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+/* code de Huffman canonique à partir des longueurs ; renvoie < 0 si
+   le code est sur-souscrit (> 0 : incomplet, toléré) */
+template <class H>
+int construct(H& h, const short* length, int n)
+{
+    std::fill(std::begin(h.count), std::end(h.count), short(0));
+    for (int s = 0; s < n; ++s) ++h.count[length[s]];
+    if (h.count[0] == n) return 0;
+
+    int left = 1;
+    for (int len = 1; len < 16; ++len) {
+        left <<= 1;
+        left -= h.count[len];
+        if (left < 0) return left;
+    }
+    short offs[16];
+    offs[1] = 0;
+    for (int len = 1; len < 15; ++len) offs[len + 1] = offs[len] + h.count[len];
+    for (int s = 0; s < n; ++s)
+        if (length[s] != 0) h.symbol[offs[length[s]]++] = static_cast<short>(s);
+    return left;
+}
+
+[[noreturn]] void bad(const char* what)
+{
+    throw std::runtime_error(std::string("gzip: ") + what);
+}
+
+} // namespace
+
+GzipSource::GzipSource(const std::string& path)
+    : src_(path), win_(WSIZE)
+{}
+
+int GzipSource::bits(int need)
+{
+    while (bitcnt_ < need) {
+        const int b = src_.get();
+        if (b < 0) bad("truncated stream");
+        bitbuf_ |= static_cast<uint32_t>(b) << bitcnt_;
+        bitcnt_ += 8;
+    }
+    const int v = static_cast<int>(bitbuf_ & ((1u << need) - 1));
+    bitbuf_ >>= need;
+    bitcnt_ -= need;
+    return v;
+}
+
+int GzipSource::decode(const Huffman& h)
+{
+    int code = 0, first = 0, index = 0;
+    for (int len = 1; len < 16; ++len) {
+        code |= bits(1);
+        const int count = h.count[len];
+        if (code - count < first) return h.symbol[index + (code - first)];
+        index += count;
+        first += count;
+        first <<= 1;
+        code  <<= 1;
+    }
+    bad("invalid Huffman code");
+}
+
+void GzipSource::read_header()
+{
+    auto byte = [&] { const int b = src_.get(); if (b < 0) bad("truncated header"); return b; };
+
+    if (byte() != 0x1F || byte() != 0x8B) bad("not a gzip file");
+    if (byte() != 8) bad("unsupported compression method");
+    const int flg = byte();
+    for (int i = 0; i < 6; ++i) byte();                  // MTIME, XFL, OS
+    if (flg & 4) {                                       // FEXTRA
+        const int lo = byte(), hi = byte();
+        for (int i = 0; i < (lo | (hi << 8)); ++i) byte();
+    }
+    if (flg & 8)  while (byte() != 0) {}                 // FNAME
+    if (flg & 16) while (byte() != 0) {}                 // FCOMMENT
+    if (flg & 2)  { byte(); byte(); }                    // FHCRC
+
+    bitbuf_ = 0; bitcnt_ = 0;
+    total_ = 0; crc_ = 0; last_ = false;
+    state_ = State::Block;
+}
+
+void GzipSource::read_trailer()
+{
+    bitbuf_ = 0; bitcnt_ = 0;                            // alignement octet
+    uint32_t crc = 0, isize = 0;
+    for (int i = 0; i < 4; ++i) crc   |= static_cast<uint32_t>(bits(8)) << (8 * i);
+    for (int i = 0; i < 4; ++i) isize |= static_cast<uint32_t>(bits(8)) << (8 * i);
+    if (crc != crc_)      bad("CRC mismatch");
+    if (isize != static_cast<uint32_t>(total_)) bad("length mismatch");   // ISIZE : modulo 2^32
+
+    /* membres concaténés : on enchaîne s'il en reste */
+    state_ = src_.peek() < 0 ? State::Done : State::Header;
+}
+
+void GzipSource::dynamic_tables()
+{
+    static const short ORDER[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+    const int nlen  = bits(5) + 257;
+    const int ndist = bits(5) + 1;
+    const int ncode = bits(4) + 4;
+    if (nlen > 286 || ndist > 30) bad("bad counts");
+
+    short lengths[320] = {};
+    for (int i = 0; i < ncode; ++i) lengths[ORDER[i]] = static_cast<short>(bits(3));
+    Huffman lencode{};
+    if (construct(lencode, lengths, 19) != 0) bad("incomplete code-length code");
+
+    for (int i = 0; i < nlen + ndist; ) {
+        int sym = decode(lencode);
+        if (sym < 16) { lengths[i++] = static_cast<short>(sym); continue; }
+        short len = 0;
+        if (sym == 16) {
+            if (i == 0) bad("repeat with no first length");
+            len = lengths[i - 1];
+            sym = 3 + bits(2);
+        }
+        else if (sym == 17) sym = 3 + bits(3);
+        else                sym = 11 + bits(7);
+        if (i + sym > nlen + ndist) bad("too many lengths");
+        while (sym--) lengths[i++] = len;
+    }
+    if (lengths[256] == 0) bad("no end-of-block code");
+
+    const int err = construct(lit_, lengths, nlen);
+    if (err < 0 || (err > 0 && nlen - lit_.count[0] != 1)) bad("incomplete literal/length code");
+    const int derr = construct(dist_, lengths + nlen, ndist);
+    if (derr < 0 || (derr > 0 && ndist - dist_.count[0] != 1)) bad("incomplete distance code");
+}
+
+void GzipSource::read_block_header()
+{
+    if (last_) { read_trailer(); return; }
+
+    last_ = bits(1) != 0;
+    switch (bits(2)) {
+    case 0: {                                            // bloc stocké
+        bitbuf_ = 0; bitcnt_ = 0;
+        const int len  = bits(16);                       // petit-boutiste = ordre des bits
+        const int nlen = bits(16);
+        if (len != (~nlen & 0xFFFF)) bad("stored block length mismatch");
+        stored_left_ = static_cast<uint32_t>(len);
+        state_ = State::Stored;
+        break;
+    }
+    case 1: {                                            // codes fixes
+        short lengths[288 + 30];
+        int s = 0;
+        for (; s < 144; ++s) lengths[s] = 8;
+        for (; s < 256; ++s) lengths[s] = 9;
+        for (; s < 280; ++s) lengths[s] = 7;
+        for (; s < 288; ++s) lengths[s] = 8;
+        for (; s < 288 + 30; ++s) lengths[s] = 5;
+        construct(lit_, lengths, 288);
+        construct(dist_, lengths + 288, 30);
+        state_ = State::Codes;
+        break;
+    }
+    case 2:
+        dynamic_tables();
+        state_ = State::Codes;
+        break;
+    default:
+        bad("invalid block type");
+    }
+}
+
+std::size_t GzipSource::read(uint8_t* dst, std::size_t n)
+{
+    std::size_t got = 0, crc_from = 0;
+    auto emit = [&](uint8_t b) {
+        win_[total_ & (WSIZE - 1)] = b;
+        ++total_;
+        dst[got++] = b;
+    };
+    /* CRC des octets produits depuis le dernier appel (avant tout
+       contrôle de fin de membre, et en sortie) */
+    auto flush_crc = [&] {
+        crc_ = crc32_update(crc_, dst + crc_from, got - crc_from);
+        crc_from = got;
+    };
+
+    while (got < n) {
+        if (copy_len_ > 0) {                              // recopie (longueur, distance)
+            emit(win_[(total_ - copy_dist_) & (WSIZE - 1)]);
+            --copy_len_;
+            continue;
+        }
+        switch (state_) {
+        case State::Header:
+            read_header();
+            break;
+        case State::Block:
+            flush_crc();
+            read_block_header();
+            break;
+        case State::Done:
+            flush_crc();
+            return got;
+        case State::Stored: {
+            if (stored_left_ == 0) { state_ = State::Block; break; }
+            const int b = src_.get();
+            if (b < 0) bad("truncated stored block");
+            emit(static_cast<uint8_t>(b));
+            --stored_left_;
+            break;
+        }
+        case State::Codes: {
+            int sym = decode(lit_);
+            if (sym < 256) { emit(static_cast<uint8_t>(sym)); break; }
+            if (sym == 256) { state_ = State::Block; break; }
+            sym -= 257;
+            if (sym >= 29) bad("invalid length symbol");
+            copy_len_ = LBASE[sym] + bits(LEXT[sym]);
+            const int ds = decode(dist_);
+            if (ds >= 30) bad("invalid distance symbol");
+            copy_dist_ = DBASE[ds] + bits(DEXT[ds]);
+            if (static_cast<uint64_t>(copy_dist_) > total_) bad("distance too far back");
+            break;
+        }
+        }
+    }
+    flush_crc();
+    return got;
+}
+
+/* ───────── IdxReader ───────────────────────────────────────────── */
+IdxReader::IdxReader(const std::string& path)
+{
+    bool gzip;
+    {
+        ByteSource probe(path);
+        const int b0 = probe.get(), b1 = probe.get();
+        gzip = b0 == 0x1F && b1 == 0x8B;
+    }
+    if (gzip) gz_    = std::make_unique<GzipSource>(path);
+    else      plain_ = std::make_unique<ByteSource>(path);
+
+    /* entête IDX : 0 0 <type> <ndims>, puis ndims tailles big-endian */
+    uint8_t h[4];
+    if (raw(h, 4) != 4) throw std::runtime_error("bad idx file " + path);
+    if (h[0] != 0 || h[1] != 0 || h[2] != 0x08)
+        throw std::runtime_error("unsupported idx type in " + path);
+    magic_ = (uint32_t(h[2]) << 8) | h[3];
+
+    dims_.resize(h[3]);
+    for (uint32_t& d : dims_) {
+        uint8_t b[4];
+        if (raw(b, 4) != 4) throw std::runtime_error("bad idx file " + path);
+        d = (uint32_t(b[0]) << 24) | (uint32_t(b[1]) << 16) | (uint32_t(b[2]) << 8) | b[3];
+    }
+    if (dims_.empty()) throw std::runtime_error("bad idx file " + path);
+    count_ = left_ = dims_[0];
+    for (std::size_t i = 1; i < dims_.size(); ++i) record_ *= dims_[i];
+    if (left_ == 0) finish();
+}
+
+std::size_t IdxReader::raw(uint8_t* dst, std::size_t n)
+{
+    return gz_ ? gz_->read(dst, n) : plain_->read(dst, n);
+}
+
+std::size_t IdxReader::read(uint8_t* dst, std::size_t n)
+{
+    const std::size_t k = std::min<std::size_t>(n, left_);
+    if (raw(dst, k * record_) != k * record_) throw std::runtime_error("truncated idx file");
+    left_ -= static_cast<uint32_t>(k);
+    if (k > 0 && left_ == 0) finish();
+    return k;
+}
+
+/* dernier enregistrement lu : on va jusqu'au bout du fichier, ce qui
+   fait vérifier CRC32 et ISIZE au décodeur gzip ; tout octet en trop
+   est une erreur */
+void IdxReader::finish()
+{
+    uint8_t extra;
+    if (raw(&extra, 1) != 0) throw std::runtime_error("trailing data after idx records");
+}
+
+/* ───────── IdxStream ───────────────────────────────────────────── */
+IdxStream::IdxStream(std::vector<IdxShard> shards, int batch_size,
+                     std::size_t shuffle_buffer, uint64_t seed,
+                     const AugmentParams* aug, int depth, int workers)
+    : shards_(std::move(shards)), batch_size_(batch_size),
+      buffer_cap_(std::max<std::size_t>(1, shuffle_buffer)), seed_(seed),
+      augment_(aug != nullptr), aug_(aug ? *aug : AugmentParams{}),
+      depth_(static_cast<std::size_t>(std::max(1, depth)))
+{
+    if (augment_)
+        for (int w = 0; w < std::max(1, workers); ++w)
+            workers_.emplace_back(&IdxStream::augment_loop, this);
+}
+
+IdxStream::~IdxStream()
+{
+    stop_producer();
+    {
+        std::lock_guard<std::mutex> lk(m_);
+        quit_ = true;
+    }
+    cv_.notify_all();
+    for (std::thread& t : workers_) t.join();
+}
+
+void IdxStream::stop_producer()
+{
+    {
+        std::lock_guard<std::mutex> lk(m_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    if (producer_.joinable()) producer_.join();
+}
+
+void IdxStream::start_epoch(int epoch)
+{
+    stop_producer();
+    {
+        /* lots de l'époque précédente abandonnés : les workers lâchent
+           d'abord ceux qu'ils augmentent encore */
+        std::unique_lock<std::mutex> lk(m_);
+        todo_.clear();
+        cv_.wait(lk, [&] { return busy_ == 0; });
+        queue_.clear();
+        error_.clear();
+        done_ = false;
+        stop_ = false;
+    }
+    producer_ = std::thread(&IdxStream::produce, this, epoch);
+}
+
+bool IdxStream::next(Batch& out)
+{
+    std::unique_lock<std::mutex> lk(m_);
+    cv_.wait(lk, [&] {
+        return !error_.empty() || (!queue_.empty() && queue_.front().ready)
+                               || (queue_.empty() && done_);
+    });
+    if (!error_.empty()) throw std::runtime_error(error_);
+    if (queue_.empty()) return false;
+    out = std::move(queue_.front().b);
+    queue_.pop_front();
+    cv_.notify_all();
+    return true;
+}
+
+bool IdxStream::push(Pending&& p)
+{
+    std::unique_lock<std::mutex> lk(m_);
+    cv_.wait(lk, [&] { return queue_.size() < depth_ || stop_; });
+    if (stop_) return false;
+    queue_.push_back(std::move(p));
+    if (!queue_.back().ready) todo_.push_back(&queue_.back());   // deque : adresse stable
+    cv_.notify_all();
+    return true;
+}
+
+/* augmentation hors du thread de décodage, un lot à la fois, en place */
+void IdxStream::augment_loop()
+{
+    std::unique_lock<std::mutex> lk(m_);
+    for (;;) {
+        cv_.wait(lk, [&] { return quit_ || !todo_.empty(); });
+        if (quit_) return;
+        Pending& p = *todo_.front();
+        todo_.pop_front();
+        ++busy_;
+        lk.unlock();
+
+        std::string err;
+        try {
+            Tensor a;
+            for (std::size_t k = 0; k < p.b.X.size(); ++k) {
+                augment_image(p.b.X[k], a, aug_, seed_, p.epoch, p.key[k]);
+                p.b.X[k].swap(a);
+            }
+        }
+        catch (const std::exception& ex) { err = ex.what(); }
+
+        lk.lock();
+        if (!err.empty() && error_.empty()) error_ = err;
+        p.ready = true;
+        --busy_;
+        cv_.notify_all();
+    }
+}
+
+void IdxStream::produce(int epoch)
+{
+    constexpr std::size_t R     = IMG_SIZE * IMG_SIZE;
+    constexpr std::size_t CHUNK = 256;                   // enregistrements par lecture
+
+    /* fin d'époque signalée quelle que soit la sortie (fin, arrêt, erreur) */
+    struct DoneGuard {
+        IdxStream* self;
+        ~DoneGuard() {
+            std::lock_guard<std::mutex> lk(self->m_);
+            self->done_ = true;
+            self->cv_.notify_all();
+        }
+    } guard{ this };
+
+    try {
+        std::mt19937 gen(static_cast<uint32_t>(seed_) + static_cast<uint32_t>(epoch));
+
+        std::vector<int> order(shards_.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::shuffle(order.begin(), order.end(), gen);
+
+        /* tampon de mélange : images uint8, 4× plus compact que float */
+        std::vector<uint8_t>  pix(buffer_cap_ * R);
+        std::vector<Label>    lab(buffer_cap_);
+        std::vector<uint64_t> key(buffer_cap_);          // (fragment, rang) : graine d'augmentation
+        std::size_t fill = 0;
+
+        /* lot en cours ; l'augmentation éventuelle revient aux workers */
+        Pending b;
+        b.epoch = epoch;
+        b.ready = !augment_;
+        auto flush = [&] {
+            Pending next;
+            next.epoch = epoch;
+            next.ready = !augment_;
+            std::swap(b, next);
+            return push(std::move(next));
+        };
+        auto emit = [&](std::size_t slot) {
+            Tensor t(R);
+            const uint8_t* p = &pix[slot * R];
+            for (std::size_t i = 0; i < R; ++i) t[i] = p[i] / 255.0f;
+            b.b.idx.push_back(static_cast<int>(b.b.X.size()));
+            b.b.X.push_back(std::move(t));
+            b.b.Y.push_back(lab[slot]);
+            b.key.push_back(key[slot]);
+            return static_cast<int>(b.b.X.size()) < batch_size_ || flush();
+        };
+
+        std::vector<uint8_t> cp(CHUNK * R);
+        std::vector<Label>   cl(CHUNK);
+        for (int s : order) {
+            IdxReader im(shards_[s].images), lb(shards_[s].labels);
+            if (im.magic() != 0x803 || im.dims_count() != 3 ||
+                im.dim(1) != IMG_SIZE || im.dim(2) != IMG_SIZE)
+                throw std::runtime_error("bad image file " + shards_[s].images);
+            if (lb.magic() != 0x801 || lb.count() != im.count())
+                throw std::runtime_error("bad label file " + shards_[s].labels);
+
+            uint64_t rec = 0;
+            for (std::size_t n; (n = im.read(cp.data(), CHUNK)) > 0; ) {
+                if (lb.read(cl.data(), n) != n)
+                    throw std::runtime_error("truncated label file " + shards_[s].labels);
+
+                for (std::size_t k = 0; k < n; ++k, ++rec) {
+                    if (cl[k] >= NUM_CLASSES)            // p[y] de la perte : hors bornes
+                        throw std::runtime_error("label out of range in " + shards_[s].labels);
+                    std::size_t slot = fill;
+                    if (fill < buffer_cap_) ++fill;
+                    else {                               // tampon plein : on sort un tirage
+                        slot = std::uniform_int_distribution<std::size_t>(0, buffer_cap_ - 1)(gen);
+                        if (!emit(slot)) return;
+                    }
+                    std::memcpy(&pix[slot * R], &cp[k * R], R);
+                    lab[slot] = cl[k];
+                    key[slot] = (static_cast<uint64_t>(s) << 32) | rec;
+                }
+            }
+        }
+
+        /* vidange du tampon dans un ordre aléatoire */
+        while (fill > 0) {
+            const std::size_t j = std::uniform_int_distribution<std::size_t>(0, fill - 1)(gen);
+            if (!emit(j)) return;
+            --fill;
+            std::memcpy(&pix[j * R], &pix[fill * R], R);
+            lab[j] = lab[fill];
+            key[j] = key[fill];
+        }
+        if (!b.b.X.empty() && !flush()) return;
+    }
+    catch (const std::exception& ex) {
+        std::lock_guard<std::mutex> lk(m_);
+        error_ = ex.what();
+    }
+}
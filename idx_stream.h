@@ -0,0 +1,150 @@
+#pragma once
+#include "augment.h"
+#include "tensor.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* ───────── Lecture de fichier par blocs ────────────────────────── */
+class ByteSource {
+public:
+    explicit ByteSource(const std::string& path);
+
+    int         get();                                   // -1 : fin de fichier
+    int         peek();
+    std::size_t read(uint8_t* dst, std::size_t n);
+
+private:
+    bool refill();
+
+    std::ifstream        f_;
+    std::vector<uint8_t> buf_;
+    std::size_t          pos_ = 0, len_ = 0;
+};
+
+/* ───────── Décompression gzip (deflate, RFC 1951/1952) ─────────── */
+/*  Décodeur en flux : ne garde que la fenêtre de 32 Ko exigée par
+ *  deflate, les données décompressées sont produites à la demande.
+ */
+class GzipSource {
+public:
+    explicit GzipSource(const std::string& path);
+
+    std::size_t read(uint8_t* dst, std::size_t n);       // < n : fin du flux
+
+private:
+    struct Huffman { short count[16]; short symbol[288]; };
+    enum class State { Header, Block, Stored, Codes, Done };
+
+    int  bits(int need);
+    int  decode(const Huffman& h);
+    void read_header();
+    void read_trailer();
+    void read_block_header();
+    void dynamic_tables();
+
+    ByteSource src_;
+    uint32_t   bitbuf_ = 0;
+    int        bitcnt_ = 0;
+
+    State    state_ = State::Header;
+    bool     last_  = false;
+    uint32_t stored_left_ = 0;
+    int      copy_len_ = 0, copy_dist_ = 0;
+    Huffman  lit_{}, dist_{};
+
+    std::vector<uint8_t> win_;                           // fenêtre glissante
+    uint64_t total_ = 0;                                 // octets du membre courant (sans repli)
+    uint32_t crc_   = 0;
+};
+
+/* ───────── Fichier IDX (brut ou .gz) lu enregistrement par enregistrement ── */
+class IdxReader {
+public:
+    explicit IdxReader(const std::string& path);         // gzip détecté à l'entête
+
+    uint32_t    magic()       const { return magic_; }
+    uint32_t    count()       const { return count_; }
+    std::size_t record_size() const { return record_; }
+    uint32_t    dim(int i)    const { return dims_[i]; }
+    int         dims_count()  const { return static_cast<int>(dims_.size()); }
+
+    /* lit jusqu'à `n` enregistrements ; renvoie le nombre lu. Après le
+       dernier, le fichier est lu jusqu'au bout (contrôles gzip) */
+    std::size_t read(uint8_t* dst, std::size_t n);
+
+private:
+    std::size_t raw(uint8_t* dst, std::size_t n);
+    void        finish();
+
+    std::unique_ptr<ByteSource> plain_;
+    std::unique_ptr<GzipSource> gz_;
+    uint32_t              magic_ = 0, count_ = 0, left_ = 0;
+    std::vector<uint32_t> dims_;
+    std::size_t           record_ = 1;
+};
+
+/* ───────── Jeu d'entraînement en flux, par fragments ───────────── */
+struct IdxShard {
+    std::string images, labels;                          // fichiers IDX appariés
+};
+
+/*  Un thread d'arrière-plan décode les fragments (ordre tiré à chaque
+ *  époque), mélange les échantillons dans un tampon borné de
+ *  `shuffle_buffer` images uint8, puis assemble des mini-lots float
+ *  dans une file de `depth` lots. Avec augmentation, `workers` threads
+ *  transforment les lots de la file hors du thread de décodage ;
+ *  next() les rend dans l'ordre de production.
+ *  La mémoire résidente ne dépend pas de la taille du jeu de données.
+ */
+class IdxStream {
+public:
+    IdxStream(std::vector<IdxShard> shards, int batch_size,
+              std::size_t shuffle_buffer, uint64_t seed,
+              const AugmentParams* aug = nullptr, int depth = 4,
+              int workers = 1);
+    ~IdxStream();
+
+    IdxStream(const IdxStream&)            = delete;
+    IdxStream& operator=(const IdxStream&) = delete;
+
+    void start_epoch(int epoch);
+    bool next(Batch& out);                               // false : fin d'époque
+
+private:
+    struct Pending {
+        Batch                 b;
+        std::vector<uint64_t> key;                       // (fragment, rang) : graine d'augmentation
+        int                   epoch = 0;
+        bool                  ready = false;             // augmenté (ou sans augmentation)
+    };
+
+    void produce(int epoch);
+    void augment_loop();
+    bool push(Pending&& p);                              // false : arrêt demandé
+    void stop_producer();
+
+    std::vector<IdxShard> shards_;
+    int                   batch_size_;
+    std::size_t           buffer_cap_;
+    uint64_t              seed_;
+    bool                  augment_;
+    AugmentParams         aug_;
+    std::size_t           depth_;
+
+    std::mutex               m_;
+    std::condition_variable  cv_;
+    std::deque<Pending>      queue_;                     // ordre de production
+    std::deque<Pending*>     todo_;                      // éléments de queue_ à augmenter
+    std::thread              producer_;
+    std::vector<std::thread> workers_;
+    int                      busy_ = 0;                  // lots en cours d'augmentation
+    bool                     done_ = true, stop_ = false, quit_ = false;
+    std::string              error_;                     // exception du producteur ou d'un worker
+};
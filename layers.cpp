@@ -1,15 +1,182 @@
 ﻿#include "layers.h"
+#include "simd.h"
+#include "thread_pool.h"
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <numeric>
+#include <stdexcept>
 
-#ifdef _OPENMP          // ajout : en-tête OpenMP
-  #include <omp.h>
+/* Grain des noyaux pour ThreadPool::parallel_for : une tranche doit
+   représenter assez de travail pour amortir sa distribution ; sous une
+   tranche, l'opération s'exécute directement dans le thread appelant. */
+constexpr int GRAIN_MACS  = 8192;     // multiplications-additions
+constexpr int GRAIN_ELEMS = 16384;    // éléments (opérations point par point)
+
+static ThreadPool& workers() { return ThreadPool::instance(); }
+
+/* ───────── Mode reproductible ─────────────────────────────────── */
+constexpr int DET_ROWS = 4;           // lignes par bloc de réduction (HWC)
+
+static std::atomic<bool> g_deterministic{ false };
+
+void set_deterministic(bool on) { g_deterministic.store(on, std::memory_order_relaxed); }
+bool deterministic()            { return g_deterministic.load(std::memory_order_relaxed); }
+
+/* parts[0, n) <- somme des `nb` tampons parts[b*n, (b+1)*n), en arbre
+   fixe ((0+1)+(2+3))+… : l'ordre des additions ne dépend que de nb */
+static void tree_reduce(float* parts, int nb, std::size_t n)
+{
+    workers().parallel_for(0, static_cast<int>(n), GRAIN_ELEMS / nb + 1, [&](int lo, int hi, int) {
+        for (int s = 1; s < nb; s *= 2)
+            for (int b = 0; b + s < nb; b += 2 * s) {
+                float*       dst = parts + static_cast<std::size_t>(b) * n;
+                const float* src = parts + static_cast<std::size_t>(b + s) * n;
+                for (int i = lo; i < hi; ++i) dst[i] += src[i];
+            }
+    });
+}
+
+/* grain effectif : `tasks` tranches imposées par l'autotuner (> 0),
+   sinon l'heuristique ci-dessus */
+static int grain_for(int tasks, int items, int heuristic)
+{
+    return tasks > 0 ? (items + tasks - 1) / tasks : std::max(1, heuristic);
+}
+
+/* ───────── Noyaux « panneau de 8 » (Dense, ConvLayer HWC) ─────── */
+/*  acc[0..8) += Σ_k x[k] * P[8k .. 8k+8) : produit d'un panneau par un
+    vecteur, accumulé dans l'ordre de k (même ordre que la boucle scalaire). */
+static void panel_gemv(const float* P, const float* x, int n, float* acc)
+{
+#if defined(RN_AVX2)
+    __m256 a = _mm256_loadu_ps(acc);
+    for (int k = 0; k < n; ++k)
+        a = _mm256_add_ps(a, _mm256_mul_ps(_mm256_set1_ps(x[k]), _mm256_loadu_ps(P + 8 * k)));
+    _mm256_storeu_ps(acc, a);
+#elif defined(RN_SSE2)
+    __m128 a0 = _mm_loadu_ps(acc), a1 = _mm_loadu_ps(acc + 4);
+    for (int k = 0; k < n; ++k) {
+        const __m128 xk = _mm_set1_ps(x[k]);
+        a0 = _mm_add_ps(a0, _mm_mul_ps(xk, _mm_loadu_ps(P + 8 * k)));
+        a1 = _mm_add_ps(a1, _mm_mul_ps(xk, _mm_loadu_ps(P + 8 * k + 4)));
+    }
+    _mm_storeu_ps(acc, a0); _mm_storeu_ps(acc + 4, a1);
+#else
+    for (int k = 0; k < n; ++k)
+        for (int r = 0; r < 8; ++r) acc[r] += x[k] * P[8 * k + r];
+#endif
+}
+
+/*  P[8k .. 8k+8) += x[k] * g[0..8) : produit extérieur (gradient des poids) */
+static void panel_ger(float* P, const float* g, const float* x, int n)
+{
+#if defined(RN_AVX2)
+    const __m256 gv = _mm256_loadu_ps(g);
+    for (int k = 0; k < n; ++k)
+        _mm256_storeu_ps(P + 8 * k, _mm256_add_ps(_mm256_loadu_ps(P + 8 * k),
+                                                  _mm256_mul_ps(_mm256_set1_ps(x[k]), gv)));
+#elif defined(RN_SSE2)
+    const __m128 g0 = _mm_loadu_ps(g), g1 = _mm_loadu_ps(g + 4);
+    for (int k = 0; k < n; ++k) {
+        const __m128 xk = _mm_set1_ps(x[k]);
+        _mm_storeu_ps(P + 8 * k,     _mm_add_ps(_mm_loadu_ps(P + 8 * k),     _mm_mul_ps(xk, g0)));
+        _mm_storeu_ps(P + 8 * k + 4, _mm_add_ps(_mm_loadu_ps(P + 8 * k + 4), _mm_mul_ps(xk, g1)));
+    }
+#else
+    for (int k = 0; k < n; ++k)
+        for (int r = 0; r < 8; ++r) P[8 * k + r] += x[k] * g[r];
+#endif
+}
+
+/*  acc[0..8) += Σ_b x[col[b]] * P[8b .. 8b+8) : panel_gemv restreint aux
+    blocs non nuls d'un panneau élagué (CSR par blocs, col croissants) */
+static void panel_spmv(const float* P, const int* col, int nb, const float* x, float* acc)
+{
+#if defined(RN_AVX2)
+    __m256 a = _mm256_loadu_ps(acc);
+    for (int b = 0; b < nb; ++b)
+        a = _mm256_add_ps(a, _mm256_mul_ps(_mm256_set1_ps(x[col[b]]), _mm256_loadu_ps(P + 8 * b)));
+    _mm256_storeu_ps(acc, a);
+#elif defined(RN_SSE2)
+    __m128 a0 = _mm_loadu_ps(acc), a1 = _mm_loadu_ps(acc + 4);
+    for (int b = 0; b < nb; ++b) {
+        const __m128 xb = _mm_set1_ps(x[col[b]]);
+        a0 = _mm_add_ps(a0, _mm_mul_ps(xb, _mm_loadu_ps(P + 8 * b)));
+        a1 = _mm_add_ps(a1, _mm_mul_ps(xb, _mm_loadu_ps(P + 8 * b + 4)));
+    }
+    _mm_storeu_ps(acc, a0); _mm_storeu_ps(acc + 4, a1);
+#else
+    for (int b = 0; b < nb; ++b)
+        for (int r = 0; r < 8; ++r) acc[r] += x[col[b]] * P[8 * b + r];
 #endif
+}
+
+/*  Même produit pour m ≤ 4 échantillons à la fois (lignes de X, pas ld) :
+    chaque bloc de poids est chargé une fois pour les m accumulateurs
+    acc[j*8 .. j*8+8). col == nullptr : panneau dense (bloc b = entrée b).
+    Les lignes au-delà de m relisent la dernière (résultats ignorés). */
+template <bool Sparse>
+static void panel_spmm4_impl(const float* P, const int* col, int nb,
+                             const float* X, int ld, int m, float* acc)
+{
+    const float* x0 = X;
+    const float* x1 = X + static_cast<std::size_t>(std::min(1, m - 1)) * ld;
+    const float* x2 = X + static_cast<std::size_t>(std::min(2, m - 1)) * ld;
+    const float* x3 = X + static_cast<std::size_t>(std::min(3, m - 1)) * ld;
+#if defined(RN_AVX2)
+    __m256 a0 = _mm256_loadu_ps(acc),      a1 = _mm256_loadu_ps(acc + 8);
+    __m256 a2 = _mm256_loadu_ps(acc + 16), a3 = _mm256_loadu_ps(acc + 24);
+    for (int b = 0; b < nb; ++b) {
+        const int    c = Sparse ? col[b] : b;
+        const __m256 w = _mm256_loadu_ps(P + 8 * b);
+        a0 = _mm256_add_ps(a0, _mm256_mul_ps(_mm256_set1_ps(x0[c]), w));
+        a1 = _mm256_add_ps(a1, _mm256_mul_ps(_mm256_set1_ps(x1[c]), w));
+        a2 = _mm256_add_ps(a2, _mm256_mul_ps(_mm256_set1_ps(x2[c]), w));
+        a3 = _mm256_add_ps(a3, _mm256_mul_ps(_mm256_set1_ps(x3[c]), w));
+    }
+    const __m256 a[4] = { a0, a1, a2, a3 };
+    for (int j = 0; j < m; ++j) _mm256_storeu_ps(acc + 8 * j, a[j]);
+#elif defined(RN_SSE2)
+    __m128 a[4][2];
+    for (int j = 0; j < 4; ++j) {
+        a[j][0] = _mm_loadu_ps(acc + 8 * j);
+        a[j][1] = _mm_loadu_ps(acc + 8 * j + 4);
+    }
+    for (int b = 0; b < nb; ++b) {
+        const int    c  = Sparse ? col[b] : b;
+        const __m128 w0 = _mm_loadu_ps(P + 8 * b), w1 = _mm_loadu_ps(P + 8 * b + 4);
+        const __m128 xb[4] = { _mm_set1_ps(x0[c]), _mm_set1_ps(x1[c]),
+                               _mm_set1_ps(x2[c]), _mm_set1_ps(x3[c]) };
+        for (int j = 0; j < 4; ++j) {
+            a[j][0] = _mm_add_ps(a[j][0], _mm_mul_ps(xb[j], w0));
+            a[j][1] = _mm_add_ps(a[j][1], _mm_mul_ps(xb[j], w1));
+        }
+    }
+    for (int j = 0; j < m; ++j) {
+        _mm_storeu_ps(acc + 8 * j,     a[j][0]);
+        _mm_storeu_ps(acc + 8 * j + 4, a[j][1]);
+    }
+#else
+    const float* x[4] = { x0, x1, x2, x3 };
+    for (int b = 0; b < nb; ++b) {
+        const int c = Sparse ? col[b] : b;
+        for (int j = 0; j < m; ++j)
+            for (int r = 0; r < 8; ++r) acc[8 * j + r] += x[j][c] * P[8 * b + r];
+    }
+#endif
+}
+
+static void panel_spmm4(const float* P, const int* col, int nb,
+                        const float* X, int ld, int m, float* acc)
+{
+    if (col) panel_spmm4_impl<true> (P, col, nb, X, ld, m, acc);
+    else     panel_spmm4_impl<false>(P, col, nb, X, ld, m, acc);
+}
 
 /* ───────── ConvLayer ─────────────────────────────────────────── */
-ConvLayer::ConvLayer(int inC, int outC, int k, std::mt19937& g)
-    : inC_(inC), outC_(outC), k_(k)
+ConvLayer::ConvLayer(int inC, int outC, int k, std::mt19937& g, Layout layout)
+    : inC_(inC), outC_(outC), k_(k), layout_(layout)
 {
     std::uniform_real_distribution<float> D(-0.05f, 0.05f);
     W_.resize(outC_ * inC_ * k_ * k_);
@@ -18,6 +185,24 @@ ConvLayer::ConvLayer(int inC, int outC, int k, std::mt19937& g)
 
     dW_.resize(W_.size()); db_.resize(b_.size());
     gW_.assign(W_.size(), 0.f); gb_.assign(b_.size(), 0.f);
+    if (layout_ == Layout::HWC) pack_hwc();
+}
+
+void ConvLayer::set_layout(Layout layout)
+{
+    layout_ = layout;
+    if (layout_ == Layout::HWC) pack_hwc();
+    else                        Wv_.clear();
+}
+
+/* W_ [oc][ic][ky][kx]  ->  Wv_ [oc/8][ky*k+kx][ic][oc%8] (complété par des 0) */
+void ConvLayer::pack_hwc()
+{
+    Wv_.assign(static_cast<std::size_t>(oc_panels()) * k_ * k_ * inC_ * 8, 0.f);
+    for (int oc = 0; oc < outC_; ++oc)
+        for (int ic = 0; ic < inC_; ++ic)
+            for (int t = 0; t < k_ * k_; ++t)
+                Wv_[wv(oc, ic, t)] = W_[(oc * inC_ + ic) * k_ * k_ + t];
 }
 
 int ConvLayer::idx(int c, int y, int x, int C, int H, int W) const
@@ -25,16 +210,26 @@ int ConvLayer::idx(int c, int y, int x, int C, int H, int W) const
     return c * H * W + y * W + x;
 }
 
-/* ---------- forward (parallélisé) ---------- */
+/* ---------- forward (entraînement : mémorise l'entrée) ---------- */
 Tensor ConvLayer::forward(const Tensor& in)
 {
     cache_ = in;
+    return infer(in);
+}
+
+/* ---------- inférence (parallélisée, const, sans cache) ---------- */
+Tensor ConvLayer::infer(const Tensor& in) const
+{
+    if (layout_ == Layout::HWC) return infer_hwc(in);
+
     const int H = IMG_SIZE;
     Tensor out(outC_ * H * H);
 
-#pragma omp parallel for collapse(2) schedule(static)
-    for (int oc = 0; oc < outC_; ++oc) {
-        for (int y = 0; y < H; ++y) {
+    /* une tâche = un bloc de lignes (oc, y) de la sortie */
+    const int grain = grain_for(tasks_, outC_ * H, GRAIN_MACS / (H * inC_ * k_ * k_));
+    workers().parallel_for(0, outC_ * H, grain, [&](int lo, int hi, int) {
+        for (int r = lo; r < hi; ++r) {
+            const int oc = r / H, y = r % H;
             for (int x = 0; x < H; ++x) {
                 float sum = b_[oc];
                 for (int ic = 0; ic < inC_; ++ic)
@@ -48,13 +243,15 @@ Tensor ConvLayer::forward(const Tensor& in)
                 out[idx(oc, y, x, outC_, H, H)] = sum;
             }
         }
-    }
+    });
     return out;
 }
 
-/* ---------- backward (parallélisé, approche simple) ---------- */
-Tensor ConvLayer::backward(const Tensor& g)            
+/* ---------- backward (parallélisé) ---------- */
+Tensor ConvLayer::backward(const Tensor& g)
 {
+    if (layout_ == Layout::HWC) return backward_hwc(g);
+
     const int H = IMG_SIZE;
 
     /* on réinitialise les cumuls globaux */
@@ -62,20 +259,21 @@ Tensor ConvLayer::backward(const Tensor& g)
     std::fill(db_.begin(), db_.end(), 0.f);
     Tensor dx(cache_.size(), 0.f);
 
-#pragma omp parallel
-    {
-        /* ---------- buffers privés au thread ---------- */
-        std::vector<float> dW_local(dW_.size(), 0.f);
-        std::vector<float> db_local(db_.size(), 0.f);
-        Tensor            dx_local(cache_.size(), 0.f);
-
-        /* ---------- boucle principale partagée ---------- */
-#pragma omp for schedule(static)
-        for (int oc = 0; oc < outC_; ++oc) {
+    /* dW_ et db_ sont découpés par canal de sortie : chaque tâche écrit
+       ses propres lignes. Seul dx est partagé => un tampon par worker,
+       ou par canal de sortie en mode reproductible. */
+    const bool det = deterministic();
+    const int  T   = workers().size();
+    const int  nb  = det ? outC_ : T;
+    std::vector<float> dx_part(static_cast<std::size_t>(nb) * dx.size(), 0.f);
+
+    workers().parallel_for(0, outC_, grain_for(tasks_, outC_, 1), [&](int lo, int hi, int tid) {
+        for (int oc = lo; oc < hi; ++oc) {
+            float* dx_local = &dx_part[static_cast<std::size_t>(det ? oc : tid) * dx.size()];
             for (int y = 0; y < H; ++y)
                 for (int x = 0; x < H; ++x) {
                     float grad = g[idx(oc, y, x, outC_, H, H)];
-                    db_local[oc] += grad;
+                    db_[oc] += grad;
 
                     for (int ic = 0; ic < inC_; ++ic)
                         for (int ky = -1; ky <= 1; ++ky)
@@ -85,20 +283,26 @@ Tensor ConvLayer::backward(const Tensor& g)
 
                                 int wi = (((oc * inC_ + ic) * k_ + (ky + 1)) * k_ + (kx + 1));
 
-                                dW_local[wi] += cache_[idx(ic, iy, ix, inC_, H, H)] * grad;
+                                dW_[wi] += cache_[idx(ic, iy, ix, inC_, H, H)] * grad;
                                 dx_local[idx(ic, iy, ix, inC_, H, H)] += W_[wi] * grad;
                             }
                 }
         }
+    });
 
-        /* ---------- fusion des résultats ---------- */
-#pragma omp critical
-        {
-            for (std::size_t i = 0; i < dW_.size(); ++i) dW_[i] += dW_local[i];
-            for (std::size_t i = 0; i < db_.size(); ++i) db_[i] += db_local[i];
-            for (std::size_t i = 0; i < dx.size(); ++i) dx[i] += dx_local[i];
-        }
-    } // fin de la région parallel
+    /* ---------- fusion des tampons de dx ---------- */
+    const int n = static_cast<int>(dx.size());
+    if (det) {
+        tree_reduce(dx_part.data(), nb, dx.size());
+        std::copy_n(dx_part.begin(), n, dx.begin());
+    }
+    else
+        workers().parallel_for(0, n, GRAIN_ELEMS / T + 1, [&](int lo, int hi, int) {
+            for (int t = 0; t < T; ++t) {
+                const float* part = &dx_part[static_cast<std::size_t>(t) * n];
+                for (int i = lo; i < hi; ++i) dx[i] += part[i];
+            }
+        });
 
     /* cumul pour le mini-lot */
     std::transform(gW_.begin(), gW_.end(), dW_.begin(),
@@ -121,35 +325,346 @@ void ConvLayer::apply_gradients(int batch_sz, float lr)
         b_[i] -= inv * gb_[i];
         gb_[i] = 0.f;
     }
+    if (layout_ == Layout::HWC) pack_hwc();
+}
+
+/* ---------- inférence HWC : convolution directe, vectorisée sur oc ---------- */
+Tensor ConvLayer::infer_hwc(const Tensor& in) const
+{
+    const int H = IMG_SIZE, K = k_ * k_, OP = oc_panels();
+    Tensor out(static_cast<std::size_t>(H) * H * outC_);
+
+    const int grain = grain_for(tasks_, H, GRAIN_MACS / (H * K * inC_ * OP * 8));
+    workers().parallel_for(0, H, grain, [&](int lo, int hi, int) {
+        for (int y = lo; y < hi; ++y)
+            for (int x = 0; x < H; ++x) {
+                float* o = &out[(static_cast<std::size_t>(y) * H + x) * outC_];
+                for (int p = 0; p < OP; ++p) {
+                    alignas(32) float acc[8] = {};
+                    for (int r = 0; r < 8 && p * 8 + r < outC_; ++r) acc[r] = b_[p * 8 + r];
+
+                    /* pixel d'entrée diffusé × vecteur de 8 poids, tap par tap */
+                    for (int ky = -1; ky <= 1; ++ky)
+                        for (int kx = -1; kx <= 1; ++kx) {
+                            const int iy = y + ky, ix = x + kx;
+                            if (iy < 0 || iy >= H || ix < 0 || ix >= H) continue;
+                            const int t = (ky + 1) * k_ + (kx + 1);
+                            panel_gemv(&Wv_[wv(p * 8, 0, t)],
+                                       &in[(static_cast<std::size_t>(iy) * H + ix) * inC_], inC_, acc);
+                        }
+                    for (int r = 0; r < 8 && p * 8 + r < outC_; ++r) o[p * 8 + r] = acc[r];
+                }
+            }
+    });
+    return out;
+}
+
+/* ---------- backward HWC ---------- */
+Tensor ConvLayer::backward_hwc(const Tensor& g)
+{
+    const int H = IMG_SIZE, K = k_ * k_, OP = oc_panels();
+    const std::size_t nwv = Wv_.size(), ndx = cache_.size(), ndb = static_cast<std::size_t>(OP) * 8;
+
+    /* lignes de sortie réparties entre workers ; les taps 3×3 se
+       recouvrent entre lignes voisines => cumuls privés par worker, ou
+       par bloc de DET_ROWS lignes en mode reproductible (tranches alors
+       alignées sur les blocs : un bloc n'est écrit que par une tâche) */
+    const bool det = deterministic();
+    const int  nb  = det ? (H + DET_ROWS - 1) / DET_ROWS : workers().size();
+    std::vector<float> dWv_part(nb * nwv, 0.f), db_part(nb * ndb, 0.f), dx_part(nb * ndx, 0.f);
+
+    int grain = grain_for(tasks_, H, GRAIN_MACS / (2 * H * K * inC_ * OP * 8));
+    if (det) grain = (grain + DET_ROWS - 1) / DET_ROWS * DET_ROWS;
+    workers().parallel_for(0, H, grain, [&](int lo, int hi, int tid) {
+        for (int y = lo; y < hi; ++y) {
+            const int part = det ? y / DET_ROWS : tid;
+            float* dWv = &dWv_part[part * nwv];
+            float* db  = &db_part[part * ndb];
+            float* dx  = &dx_part[part * ndx];
+            for (int x = 0; x < H; ++x)
+                for (int p = 0; p < OP; ++p) {
+                    alignas(32) float gp[8] = {};
+                    for (int r = 0; r < 8 && p * 8 + r < outC_; ++r) {
+                        gp[r] = g[(static_cast<std::size_t>(y) * H + x) * outC_ + p * 8 + r];
+                        db[p * 8 + r] += gp[r];
+                    }
+                    for (int ky = -1; ky <= 1; ++ky)
+                        for (int kx = -1; kx <= 1; ++kx) {
+                            const int iy = y + ky, ix = x + kx;
+                            if (iy < 0 || iy >= H || ix < 0 || ix >= H) continue;
+                            const int t = (ky + 1) * k_ + (kx + 1);
+                            const std::size_t pix = (static_cast<std::size_t>(iy) * H + ix) * inC_;
+
+                            panel_ger(&dWv[wv(p * 8, 0, t)], gp, &cache_[pix], inC_);
+                            const float* w = &Wv_[wv(p * 8, 0, t)];
+                            for (int ic = 0; ic < inC_; ++ic) {
+                                float s = 0.f;
+                                for (int r = 0; r < 8; ++r) s += w[ic * 8 + r] * gp[r];
+                                dx[pix + ic] += s;
+                            }
+                        }
+                }
+        }
+    });
+
+    /* fusion (dans l'ordre des workers, ou en arbre fixe sur les blocs),
+       puis retour à la disposition de W_ */
+    Tensor dx(ndx, 0.f);
+    std::vector<float> dWv(nwv, 0.f), db(ndb, 0.f);
+    if (det) {
+        tree_reduce(dx_part.data(),  nb, ndx);
+        tree_reduce(dWv_part.data(), nb, nwv);
+        tree_reduce(db_part.data(),  nb, ndb);
+        std::copy_n(dx_part.begin(),  ndx, dx.begin());
+        std::copy_n(dWv_part.begin(), nwv, dWv.begin());
+        std::copy_n(db_part.begin(),  ndb, db.begin());
+    }
+    else
+        for (int t = 0; t < nb; ++t) {
+            for (std::size_t i = 0; i < ndx; ++i) dx[i]  += dx_part[t * ndx + i];
+            for (std::size_t i = 0; i < nwv; ++i) dWv[i] += dWv_part[t * nwv + i];
+            for (std::size_t i = 0; i < ndb; ++i) db[i]  += db_part[t * ndb + i];
+        }
+    for (int oc = 0; oc < outC_; ++oc) {
+        gb_[oc] += db[oc];
+        for (int ic = 0; ic < inC_; ++ic)
+            for (int t = 0; t < K; ++t)
+                gW_[(oc * inC_ + ic) * K + t] += dWv[wv(oc, ic, t)];
+    }
+    return dx;
 }
 
 /* ───────── ReLU ─────────────────────────────────────────────── */
+/*  Le cache ne garde que le signe de l'entrée : 1 bit par élément,
+    regroupé par octets de 8 (bit k de l'octet b  <=>  in[8b + k] > 0). */
+static uint8_t relu_pack8(const float* in, float* y)
+{
+#if defined(RN_AVX2)
+    const __m256 v = _mm256_loadu_ps(in);
+    const __m256 m = _mm256_cmp_ps(v, _mm256_setzero_ps(), _CMP_GT_OQ);
+    _mm256_storeu_ps(y, _mm256_and_ps(v, m));
+    return static_cast<uint8_t>(_mm256_movemask_ps(m));
+#elif defined(RN_SSE2)
+    const __m128 z  = _mm_setzero_ps();
+    const __m128 v0 = _mm_loadu_ps(in),      v1 = _mm_loadu_ps(in + 4);
+    const __m128 m0 = _mm_cmpgt_ps(v0, z),   m1 = _mm_cmpgt_ps(v1, z);
+    _mm_storeu_ps(y,     _mm_and_ps(v0, m0));
+    _mm_storeu_ps(y + 4, _mm_and_ps(v1, m1));
+    return static_cast<uint8_t>(_mm_movemask_ps(m0) | (_mm_movemask_ps(m1) << 4));
+#else
+    uint8_t bits = 0;
+    for (int k = 0; k < 8; ++k) {
+        const bool pos = in[k] > 0.f;
+        y[k] = pos ? in[k] : 0.f;
+        bits |= static_cast<uint8_t>(pos) << k;
+    }
+    return bits;
+#endif
+}
+
+static void relu_unpack8(uint8_t bits, const float* g, float* dx)
+{
+#if defined(RN_AVX2)
+    const __m256i sel = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    const __m256i m   = _mm256_cmpeq_epi32(
+        _mm256_and_si256(_mm256_set1_epi32(bits), sel), sel);
+    _mm256_storeu_ps(dx, _mm256_and_ps(_mm256_loadu_ps(g), _mm256_castsi256_ps(m)));
+#elif defined(RN_SSE2)
+    const __m128i sel = _mm_setr_epi32(1, 2, 4, 8);
+    const __m128i m0  = _mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32(bits), sel), sel);
+    const __m128i m1  = _mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32(bits >> 4), sel), sel);
+    _mm_storeu_ps(dx,     _mm_and_ps(_mm_loadu_ps(g),     _mm_castsi128_ps(m0)));
+    _mm_storeu_ps(dx + 4, _mm_and_ps(_mm_loadu_ps(g + 4), _mm_castsi128_ps(m1)));
+#else
+    for (int k = 0; k < 8; ++k)
+        dx[k] = (bits >> k) & 1u ? g[k] : 0.f;
+#endif
+}
+
+Tensor ReLU::infer(const Tensor& in) const
+{
+    Tensor y(in.size());
+
+    workers().parallel_for(0, static_cast<int>(in.size()), GRAIN_ELEMS, [&](int lo, int hi, int) {
+        for (int i = lo; i < hi; ++i)
+            y[i] = in[i] > 0.f ? in[i] : 0.f;
+    });
+
+    return y;
+}
+
 Tensor ReLU::forward(const Tensor& in)
 {
-    cache_ = in;
+    const int n    = static_cast<int>(in.size());
+    const int full = n / 8;                      // octets complets
     Tensor y(in.size());
+    mask_.assign((n + 7) / 8, 0);
 
-#pragma omp parallel for schedule(static)
-    for (std::size_t i = 0; i < in.size(); ++i)
-        y[i] = in[i] > 0.f ? in[i] : 0.f;
+    workers().parallel_for(0, full, GRAIN_ELEMS / 8, [&](int lo, int hi, int) {
+        for (int b = lo; b < hi; ++b)
+            mask_[b] = relu_pack8(&in[8 * b], &y[8 * b]);
+    });
 
+    for (int i = 8 * full; i < n; ++i) {         // reste (< 8 éléments)
+        const bool pos = in[i] > 0.f;
+        y[i] = pos ? in[i] : 0.f;
+        mask_[full] |= static_cast<uint8_t>(pos) << (i - 8 * full);
+    }
     return y;
 }
 
-Tensor ReLU::backward(const Tensor& g)                 /* PARALLEL_CANDIDATE_OpenMP */
+Tensor ReLU::backward(const Tensor& g)
 {
+    const int n    = static_cast<int>(g.size());
+    const int full = n / 8;
     Tensor dx(g.size());
-    for (std::size_t i = 0; i < g.size(); ++i)
-        dx[i] = cache_[i] > 0.f ? g[i] : 0.f;
+
+    workers().parallel_for(0, full, GRAIN_ELEMS / 8, [&](int lo, int hi, int) {
+        for (int b = lo; b < hi; ++b)
+            relu_unpack8(mask_[b], &g[8 * b], &dx[8 * b]);
+    });
+
+    for (int i = 8 * full; i < n; ++i)
+        dx[i] = (mask_[full] >> (i - 8 * full)) & 1u ? g[i] : 0.f;
     return dx;
 }
 
 /* ───────── MaxPool ─────────────────────────────────────────── */
+/*  Au lieu d'un indice absolu (int) par sortie, on mémorise la position
+    gagnante dans la fenêtre 2×2 sur 2 bits : code = py*2 + px.
+    Les W_ = 14 codes d'une ligne de sortie tiennent dans un uint32_t
+    (28 bits), ce qui garde chaque ligne indépendante entre threads. */
+static_assert(2 * (IMG_SIZE / 2) <= 32, "une ligne de codes MaxPool doit tenir dans 32 bits");
+
 int MaxPool::idx(int c, int y, int x, int C, int H, int W) const
 {
     return c * H * W + y * W + x;
 }
 
+#if defined(RN_SSE2)
+/* étale 4 bits (b3 b2 b1 b0) sur les positions paires d'un octet */
+static const uint8_t SPREAD4[16] = {
+    0x00, 0x01, 0x04, 0x05, 0x10, 0x11, 0x14, 0x15,
+    0x40, 0x41, 0x44, 0x45, 0x50, 0x51, 0x54, 0x55 };
+#endif
+
+/*  Noyau commun à forward et infer : `code` reçoit un mot par ligne
+    (c, y) ou vaut nullptr quand on n'a pas besoin du backward. */
+void MaxPool::pool(const Tensor& in, Tensor& out, uint32_t* code,
+                   int C, int H, int W) const
+{
+    /* Chaque ligne (c, y) produit son propre mot de codes :
+       aucune écriture partagée entre threads. */
+    workers().parallel_for(0, C * H, GRAIN_ELEMS / (4 * W), [&](int lo, int hi, int) {
+        for (int r = lo; r < hi; ++r)
+        {
+            const int c = r / H, y = r % H;
+            const float* r0 = &in[idx(c, 2 * y,     0, C, IMG_SIZE, IMG_SIZE)];
+            const float* r1 = &in[idx(c, 2 * y + 1, 0, C, IMG_SIZE, IMG_SIZE)];
+            float*       o  = &out[idx(c, y, 0, C, H, W)];
+            uint32_t word = 0;
+            int x = 0;
+
+#if defined(RN_SSE2)
+            /* 4 sorties à la fois : désentrelacement colonnes paires/impaires,
+               puis balayage (0,0) (0,1) (1,0) (1,1) avec le même '>' strict
+               que la version scalaire. */
+            for (; x + 4 <= W; x += 4) {
+                const __m128 a0 = _mm_loadu_ps(r0 + 2 * x), b0 = _mm_loadu_ps(r0 + 2 * x + 4);
+                const __m128 a1 = _mm_loadu_ps(r1 + 2 * x), b1 = _mm_loadu_ps(r1 + 2 * x + 4);
+                const __m128 cand[4] = {
+                    _mm_shuffle_ps(a0, b0, _MM_SHUFFLE(2, 0, 2, 0)),
+                    _mm_shuffle_ps(a0, b0, _MM_SHUFFLE(3, 1, 3, 1)),
+                    _mm_shuffle_ps(a1, b1, _MM_SHUFFLE(2, 0, 2, 0)),
+                    _mm_shuffle_ps(a1, b1, _MM_SHUFFLE(3, 1, 3, 1)) };
+
+                __m128 best = cand[0];
+                __m128 px   = _mm_setzero_ps();        // bit 0 du code
+                __m128 py   = _mm_setzero_ps();        // bit 1 du code
+                for (int k = 1; k < 4; ++k) {
+                    const __m128 m = _mm_cmpgt_ps(cand[k], best);
+                    best = _mm_or_ps(_mm_and_ps(m, cand[k]), _mm_andnot_ps(m, best));
+                    px   = (k & 1) ? _mm_or_ps(px, m) : _mm_andnot_ps(m, px);
+                    py   = (k & 2) ? _mm_or_ps(py, m) : _mm_andnot_ps(m, py);
+                }
+                _mm_storeu_ps(o + x, best);
+
+                const uint32_t packed = SPREAD4[_mm_movemask_ps(px)]
+                                      | (SPREAD4[_mm_movemask_ps(py)] << 1);
+                word |= packed << (2 * x);
+            }
+#endif
+            for (; x < W; ++x) {
+                float    best = r0[2 * x];
+                uint32_t code = 0;
+                for (uint32_t k = 1; k < 4; ++k) {
+                    const float v = (k & 2 ? r1 : r0)[2 * x + (k & 1)];
+                    if (v > best) { best = v; code = k; }
+                }
+                o[x]  = best;
+                word |= code << (2 * x);
+            }
+            if (code) code[c * H + y] = word;        // accès unique, thread-safe
+        }
+    });
+}
+
+/*  Variante HWC : une tâche par ligne de sortie y, tous canaux ; les
+    4 candidats d'une fenêtre sont 4 vecteurs de canaux contigus. Les
+    codes gardent la disposition CHW (mot code[c*H + y]). */
+void MaxPool::pool_hwc(const Tensor& in, Tensor& out, uint32_t* code,
+                       int C, int H, int W) const
+{
+    const int IW = IMG_SIZE;
+    workers().parallel_for(0, H, std::max(1, GRAIN_ELEMS / (4 * W * C)), [&](int lo, int hi, int) {
+        std::vector<uint32_t> word(C);
+        for (int y = lo; y < hi; ++y)
+        {
+            std::fill(word.begin(), word.end(), 0u);
+            for (int x = 0; x < W; ++x) {
+                const float* cand[4] = {
+                    &in[((2 * y)     * IW + 2 * x)     * C],
+                    &in[((2 * y)     * IW + 2 * x + 1) * C],
+                    &in[((2 * y + 1) * IW + 2 * x)     * C],
+                    &in[((2 * y + 1) * IW + 2 * x + 1) * C] };
+                float* o = &out[(y * W + x) * C];
+                int c = 0;
+
+#if defined(RN_SSE2)
+                /* 4 canaux à la fois, même balayage et même '>' strict */
+                for (; c + 4 <= C; c += 4) {
+                    __m128 best = _mm_loadu_ps(cand[0] + c);
+                    __m128 px   = _mm_setzero_ps();
+                    __m128 py   = _mm_setzero_ps();
+                    for (int k = 1; k < 4; ++k) {
+                        const __m128 v = _mm_loadu_ps(cand[k] + c);
+                        const __m128 m = _mm_cmpgt_ps(v, best);
+                        best = _mm_or_ps(_mm_and_ps(m, v), _mm_andnot_ps(m, best));
+                        px   = (k & 1) ? _mm_or_ps(px, m) : _mm_andnot_ps(m, px);
+                        py   = (k & 2) ? _mm_or_ps(py, m) : _mm_andnot_ps(m, py);
+                    }
+                    _mm_storeu_ps(o + c, best);
+
+                    const int bx = _mm_movemask_ps(px), by = _mm_movemask_ps(py);
+                    for (int j = 0; j < 4; ++j)
+                        word[c + j] |= (((bx >> j) & 1u) | (((by >> j) & 1u) << 1)) << (2 * x);
+                }
+#endif
+                for (; c < C; ++c) {
+                    float    best = cand[0][c];
+                    uint32_t k0 = 0;
+                    for (uint32_t k = 1; k < 4; ++k)
+                        if (cand[k][c] > best) { best = cand[k][c]; k0 = k; }
+                    o[c] = best;
+                    word[c] |= k0 << (2 * x);
+                }
+            }
+            if (code)
+                for (int c = 0; c < C; ++c) code[c * H + y] = word[c];
+        }
+    });
+}
+
 Tensor MaxPool::forward(const Tensor& in)
 {
     C_ = static_cast<int>(in.size()) / (IMG_SIZE * IMG_SIZE);
@@ -157,34 +672,20 @@ Tensor MaxPool::forward(const Tensor& in)
     W_ = H_;
 
     Tensor out(C_ * H_ * W_);
+    code_.assign(C_ * H_, 0u);
+    if (layout_ == Layout::HWC) pool_hwc(in, out, code_.data(), C_, H_, W_);
+    else                        pool    (in, out, code_.data(), C_, H_, W_);
+    return out;
+}
 
-    /* --- on pré-alloue argmax_ pour éviter les push_back concurrents --- */
-    argmax_.assign(out.size(), 0);
-
-    /* Chaque couple (c, y, x) est indépendant ; on peut donc
-       paralléliser les trois boucles imbriquées. */
-#pragma omp parallel for collapse(3) schedule(static)
-    for (int c = 0; c < C_; ++c)
-        for (int y = 0; y < H_; ++y)
-            for (int x = 0; x < W_; ++x)
-            {
-                float best   = -1e9f;
-                int   best_i = 0;
-
-                /* balayage 2 × 2 */
-                for (int py = 0; py < 2; ++py)
-                    for (int px = 0; px < 2; ++px) {
-                        int iy = y * 2 + py,
-                            ix = x * 2 + px;
-                        int i = idx(c, iy, ix, C_, IMG_SIZE, IMG_SIZE);
-                        if (in[i] > best) { best = in[i]; best_i = i; }
-                    }
-
-                std::size_t out_idx = idx(c, y, x, C_, H_, W_);
-                out[out_idx]   = best;
-                argmax_[out_idx] = best_i;          // accès unique, thread-safe
-            }
+Tensor MaxPool::infer(const Tensor& in) const
+{
+    const int C = static_cast<int>(in.size()) / (IMG_SIZE * IMG_SIZE);
+    const int H = IMG_SIZE / 2;
 
+    Tensor out(C * H * H);
+    if (layout_ == Layout::HWC) pool_hwc(in, out, nullptr, C, H, H);
+    else                        pool    (in, out, nullptr, C, H, H);
     return out;
 }
 
@@ -193,95 +694,273 @@ Tensor MaxPool::backward(const Tensor& g)
 {
     Tensor dx(C_ * IMG_SIZE * IMG_SIZE, 0.f);
 
-    /*  Chaque élément de g correspond à un indice UNIQUE dans argmax_
-        (les fenêtres 2×2 ne se chevauchent pas).  Les écritures dans dx
-        sont donc distinctes : on peut paralléliser la boucle sans
-        mécanisme de synchronisation. */
-#pragma omp parallel for schedule(static)
-    for (std::size_t i = 0; i < argmax_.size(); ++i)
-        dx[argmax_[i]] = g[i];
+    if (layout_ == Layout::HWC) {
+        workers().parallel_for(0, H_, std::max(1, GRAIN_ELEMS / (4 * W_ * C_)), [&](int lo, int hi, int) {
+            for (int y = lo; y < hi; ++y)
+                for (int x = 0; x < W_; ++x)
+                    for (int c = 0; c < C_; ++c) {
+                        const uint32_t k = (code_[c * H_ + y] >> (2 * x)) & 3u;
+                        dx[((2 * y + (k >> 1)) * IMG_SIZE + 2 * x + (k & 1)) * C_ + c] =
+                            g[(y * W_ + x) * C_ + c];
+                    }
+        });
+        return dx;
+    }
+
+    /*  Les fenêtres 2×2 ne se chevauchent pas : chaque ligne (c, y)
+        écrit deux lignes d'entrée qui lui sont propres. */
+    workers().parallel_for(0, C_ * H_, GRAIN_ELEMS / (4 * W_), [&](int lo, int hi, int) {
+        for (int r = lo; r < hi; ++r)
+        {
+            const int c = r / H_, y = r % H_;
+            const uint32_t word = code_[c * H_ + y];
+            const float* gr = &g[idx(c, y, 0, C_, H_, W_)];
+            float*       d0 = &dx[idx(c, 2 * y,     0, C_, IMG_SIZE, IMG_SIZE)];
+            float*       d1 = &dx[idx(c, 2 * y + 1, 0, C_, IMG_SIZE, IMG_SIZE)];
+            int x = 0;
+
+#if defined(RN_SSE2)
+            /* décodage de 4 codes : masque (code == k) par voie, puis
+               réentrelacement pour écrire les deux lignes d'un bloc. */
+            const __m128i sel = _mm_setr_epi32(3, 3 << 2, 3 << 4, 3 << 6);
+            for (; x + 4 <= W_; x += 4) {
+                const __m128i cw = _mm_and_si128(
+                    _mm_set1_epi32(static_cast<int>(word >> (2 * x))), sel);
+                const __m128 gv = _mm_loadu_ps(gr + x);
+                __m128 part[4];
+                for (int k = 0; k < 4; ++k) {
+                    const __m128i want = _mm_setr_epi32(k, k << 2, k << 4, k << 6);
+                    part[k] = _mm_and_ps(gv, _mm_castsi128_ps(_mm_cmpeq_epi32(cw, want)));
+                }
+                _mm_storeu_ps(d0 + 2 * x,     _mm_unpacklo_ps(part[0], part[1]));
+                _mm_storeu_ps(d0 + 2 * x + 4, _mm_unpackhi_ps(part[0], part[1]));
+                _mm_storeu_ps(d1 + 2 * x,     _mm_unpacklo_ps(part[2], part[3]));
+                _mm_storeu_ps(d1 + 2 * x + 4, _mm_unpackhi_ps(part[2], part[3]));
+            }
+#endif
+            for (; x < W_; ++x) {
+                const uint32_t code = (word >> (2 * x)) & 3u;
+                (code & 2 ? d1 : d0)[2 * x + (code & 1)] = gr[x];
+            }
+        }
+    });
 
     return dx;
 }
 
-
 /* ───────── Dense ───────────────────────────────────────────── */
+static_assert(Dense::PANEL == 8, "les noyaux SIMD de Dense supposent des panneaux de 8");
+
 Dense::Dense(int inD, int outD, std::mt19937& g)
-    : inD_(inD), outD_(outD)
+    : inD_(inD), outD_(outD),
+      P_((outD + PANEL - 1) / PANEL), Q_((inD + PANEL - 1) / PANEL)
 {
+    /* tirage dans l'ordre ligne par ligne [o][i], puis rangement en panneaux */
     std::uniform_real_distribution<float> D(-0.05f, 0.05f);
-    W_.resize(inD_ * outD_);
-    for (float& w : W_) w = D(g);
-    b_.resize(outD_);
+    W_.assign(static_cast<std::size_t>(P_) * inD_ * PANEL, 0.f);
+    for (int o = 0; o < outD_; ++o)
+        for (int i = 0; i < inD_; ++i) W_[wp(o, i)] = D(g);
+    b_.assign(P_ * PANEL, 0.f);
 
-    dW_.resize(W_.size()); db_.resize(b_.size());
     gW_.assign(W_.size(), 0.f); gb_.assign(b_.size(), 0.f);
+    WT_.assign(static_cast<std::size_t>(Q_) * outD_ * PANEL, 0.f);
 }
 
-/* ---------- forward (parallélisé) ---------- */
+/* copie transposée [Q_][outD_][PANEL] : WT(q, o, r) = W(o, q*PANEL + r) */
+void Dense::pack_transpose()
+{
+    workers().parallel_for(0, Q_, grain_for(tasks_, Q_, GRAIN_ELEMS / (PANEL * outD_)), [&](int lo, int hi, int) {
+        for (int q = lo; q < hi; ++q)
+            for (int o = 0; o < outD_; ++o)
+                for (int r = 0; r < PANEL; ++r) {
+                    const int i = q * PANEL + r;
+                    WT_[(static_cast<std::size_t>(q) * outD_ + o) * PANEL + r] =
+                        i < inD_ ? W_[wp(o, i)] : 0.f;
+                }
+    });
+    wt_stale_ = false;
+}
+
+/* ---------- forward (entraînement : mémorise l'entrée) ---------- */
 Tensor Dense::forward(const Tensor& in)
 {
     cache_ = in;
-    Tensor y(outD_);
+    return infer(in);
+}
 
-#pragma omp parallel for schedule(static)
-    for (int o = 0; o < outD_; ++o) {
-        float s = b_[o];
-        for (int i = 0; i < inD_; ++i)
-            s += in[i] * W_[o * inD_ + i];
-        y[o] = s;
-    }
+/* ---------- inférence (parallélisée par panneau, const, sans cache) ---------- */
+Tensor Dense::infer(const Tensor& in) const
+{
+    Tensor y(outD_);
+    const bool sparse = !keep_.empty();
+    const int  per_panel = sparse ? std::max(1, static_cast<int>(bcol_.size()) / P_) : inD_;
+
+    workers().parallel_for(0, P_, grain_for(tasks_, P_, GRAIN_MACS / (PANEL * per_panel)), [&](int lo, int hi, int) {
+        for (int p = lo; p < hi; ++p) {
+            alignas(32) float acc[PANEL];
+            std::copy_n(&b_[p * PANEL], PANEL, acc);
+            if (sparse)
+                panel_spmv(&bval_[static_cast<std::size_t>(bptr_[p]) * PANEL], &bcol_[bptr_[p]],
+                           bptr_[p + 1] - bptr_[p], in.data(), acc);
+            else
+                panel_gemv(&W_[static_cast<std::size_t>(p) * inD_ * PANEL], in.data(), inD_, acc);
+            for (int r = 0; r < PANEL && p * PANEL + r < outD_; ++r) y[p * PANEL + r] = acc[r];
+        }
+    });
     return y;
 }
 
 /* ---------- backward (parallélisé) ---------- */
 Tensor Dense::backward(const Tensor& g)
 {
-    /* réinitialise les cumuls globaux */
-    std::fill(dW_.begin(), dW_.end(), 0.f);
-    std::fill(db_.begin(), db_.end(), 0.f);
-    Tensor dx(inD_, 0.f);
-
-#pragma omp parallel
-    {
-        /* --- buffers privés à chaque thread --- */
-        std::vector<float> dW_local(dW_.size(), 0.f);
-        std::vector<float> db_local(db_.size(), 0.f);
-        Tensor            dx_local(inD_, 0.f);
-
-        /* --- boucle principale partagée --- */
-#pragma omp for schedule(static)
-        for (int o = 0; o < outD_; ++o) {
-            db_local[o] += g[o];
-
-            for (int i = 0; i < inD_; ++i) {
-                dW_local[o * inD_ + i] += cache_[i] * g[o];
-                dx_local[i]            += W_[o * inD_ + i] * g[o];
+    if (wt_stale_) pack_transpose();           // 1×/mini-lot, après apply_gradients
+    Tensor dx(inD_);
+
+    /* gradient des poids : panneaux de sorties disjoints, cumulés
+       directement dans gW_ / gb_ */
+    workers().parallel_for(0, P_, grain_for(tasks_, P_, GRAIN_MACS / (PANEL * inD_)), [&](int lo, int hi, int) {
+        for (int p = lo; p < hi; ++p) {
+            alignas(32) float gp[PANEL] = {};
+            for (int r = 0; r < PANEL && p * PANEL + r < outD_; ++r) {
+                gp[r] = g[p * PANEL + r];
+                gb_[p * PANEL + r] += gp[r];
             }
+            panel_ger(&gW_[static_cast<std::size_t>(p) * inD_ * PANEL], gp, cache_.data(), inD_);
         }
+    });
+
+    /* dx = Wᵀ g : panneaux d'entrées disjoints, aucune réduction entre threads */
+    workers().parallel_for(0, Q_, grain_for(tasks_, Q_, GRAIN_MACS / (PANEL * outD_)), [&](int lo, int hi, int) {
+        for (int q = lo; q < hi; ++q) {
+            alignas(32) float acc[PANEL] = {};
+            panel_gemv(&WT_[static_cast<std::size_t>(q) * outD_ * PANEL], g.data(), outD_, acc);
+            for (int r = 0; r < PANEL && q * PANEL + r < inD_; ++r) dx[q * PANEL + r] = acc[r];
+        }
+    });
 
-        /* --- fusion dans les buffers globaux --- */
-#pragma omp critical
-        {
-            for (std::size_t k = 0; k < dW_.size(); ++k) dW_[k] += dW_local[k];
-            for (std::size_t k = 0; k < db_.size(); ++k) db_[k] += db_local[k];
-            for (std::size_t k = 0; k < dx.size();  ++k) dx[k]  += dx_local[k];
+    return dx;
+}
+
+
+void Dense::permute_inputs(const std::vector<int>& src)
+{
+    if (static_cast<int>(src.size()) != inD_)
+        throw std::runtime_error("Dense::permute_inputs : taille de permutation invalide");
+
+    Tensor W(W_.size(), 0.f);
+    for (int o = 0; o < outD_; ++o)
+        for (int i = 0; i < inD_; ++i) W[wp(o, i)] = W_[wp(o, src[i])];
+    W_.swap(W);
+    wt_stale_ = true;
+
+    if (!keep_.empty()) {
+        std::vector<uint8_t> keep(keep_.size());
+        for (int p = 0; p < P_; ++p)
+            for (int i = 0; i < inD_; ++i) keep[p * inD_ + i] = keep_[p * inD_ + src[i]];
+        keep_.swap(keep);
+        build_csr();
+    }
+}
+
+/* ---------- inférence par lot ---------- */
+/*  Tuiles de 4 échantillons (4 × inD_ floats, restent en L1) parcourant
+    tous les panneaux : chaque bloc de poids lu sert 4 échantillons. */
+Tensor Dense::infer_batch(const Tensor& X, int n) const
+{
+    Tensor Y(static_cast<std::size_t>(n) * outD_);
+    const bool sparse = !keep_.empty();
+    const int  nnzb   = sparse ? static_cast<int>(bcol_.size()) : P_ * inD_;
+    const int  tiles  = (n + 3) / 4;
+
+    workers().parallel_for(0, tiles, grain_for(tasks_, tiles, GRAIN_MACS / (4 * PANEL * std::max(1, nnzb))),
+                           [&](int lo, int hi, int) {
+        for (int t = lo; t < hi; ++t) {
+            const int s = 4 * t, m = std::min(4, n - s);
+            for (int p = 0; p < P_; ++p) {
+                alignas(32) float acc[4 * PANEL];
+                for (int j = 0; j < 4; ++j) std::copy_n(&b_[p * PANEL], PANEL, acc + j * PANEL);
+                if (sparse)
+                    panel_spmm4(&bval_[static_cast<std::size_t>(bptr_[p]) * PANEL], &bcol_[bptr_[p]],
+                                bptr_[p + 1] - bptr_[p], &X[static_cast<std::size_t>(s) * inD_], inD_, m, acc);
+                else
+                    panel_spmm4(&W_[static_cast<std::size_t>(p) * inD_ * PANEL], nullptr,
+                                inD_, &X[static_cast<std::size_t>(s) * inD_], inD_, m, acc);
+                for (int j = 0; j < m; ++j)
+                    for (int r = 0; r < PANEL && p * PANEL + r < outD_; ++r)
+                        Y[static_cast<std::size_t>(s + j) * outD_ + p * PANEL + r] = acc[j * PANEL + r];
+            }
         }
-    } // fin région parallel
+    });
+    return Y;
+}
 
-    /* cumul vers le mini-lot */
-    std::transform(gW_.begin(), gW_.end(), dW_.begin(),
-                   gW_.begin(), std::plus<float>());
-    std::transform(gb_.begin(), gb_.end(), db_.begin(),
-                   gb_.begin(), std::plus<float>());
+/* ---------- élagage ---------- */
+void Dense::prune(float sparsity)
+{
+    /*  Classement panneau par panneau : les voies de remplissage du
+        dernier panneau (outD_ non multiple de PANEL) sont nulles et
+        feraient passer toutes ses sorties en tête d'un classement
+        global. Chaque panneau perd ainsi la même part de ses blocs. */
+    const int cut = std::min(inD_, std::max(0, static_cast<int>(sparsity * inD_ + 0.5f)));
+    std::vector<float> norm(inD_);
+    std::vector<int>   order(inD_);
+
+    keep_.assign(static_cast<std::size_t>(P_) * inD_, 1);
+    for (int p = 0; p < P_; ++p) {
+        const std::size_t base = static_cast<std::size_t>(p) * inD_;
+        for (int i = 0; i < inD_; ++i) {
+            float s = 0.f;
+            for (int r = 0; r < PANEL; ++r) s += W_[(base + i) * PANEL + r] * W_[(base + i) * PANEL + r];
+            norm[i] = s;
+        }
 
-    return dx;
+        /* les `cut` blocs de plus faible norme du panneau (déjà nuls compris) */
+        std::iota(order.begin(), order.end(), 0);
+        std::nth_element(order.begin(), order.begin() + cut, order.end(),
+                         [&](int a, int b) { return norm[a] < norm[b] || (norm[a] == norm[b] && a < b); });
+        for (int k = 0; k < cut; ++k) {
+            keep_[base + order[k]] = 0;
+            std::fill_n(&W_[(base + order[k]) * PANEL], PANEL, 0.f);
+        }
+    }
+    build_csr();
+    wt_stale_ = true;
+}
+
+void Dense::build_csr()
+{
+    bptr_.assign(P_ + 1, 0);
+    bcol_.clear();
+    bval_.clear();
+    for (int p = 0; p < P_; ++p) {
+        for (int i = 0; i < inD_; ++i) {
+            if (!keep_[p * inD_ + i]) continue;
+            bcol_.push_back(i);
+            bval_.insert(bval_.end(), &W_[wp(p * PANEL, i)], &W_[wp(p * PANEL, i)] + PANEL);
+        }
+        bptr_[p + 1] = static_cast<int>(bcol_.size());
+    }
 }
 
+DenseCost Dense::cost() const
+{
+    DenseCost c;
+    c.blocks = static_cast<double>(P_) * inD_;
+    const double nnzb = keep_.empty() ? c.blocks : static_cast<double>(bcol_.size());
+    c.zero_blocks = c.blocks - nnzb;
+    c.flops = 2.0 * PANEL * nnzb;
+    c.bytes = sizeof(float) * (PANEL * nnzb + P_ * PANEL)                      // poids + biais
+            + (keep_.empty() ? 0.0 : sizeof(int) * (nnzb + P_ + 1));          // index CSR
+    return c;
+}
 
 void Dense::apply_gradients(int batch_sz, float lr)
 {
     const float inv = lr / batch_sz;
+    if (!keep_.empty())                        // blocs élagués : gradient ignoré
+        for (std::size_t b = 0; b < keep_.size(); ++b)
+            if (!keep_[b]) std::fill_n(&gW_[b * PANEL], PANEL, 0.f);
+
     for (size_t i = 0; i < W_.size(); ++i) {
         W_[i] -= inv * gW_[i];
         gW_[i] = 0.f;
@@ -290,4 +969,6 @@ void Dense::apply_gradients(int batch_sz, float lr)
         b_[i] -= inv * gb_[i];
         gb_[i] = 0.f;
     }
+    wt_stale_ = true;
+    if (!keep_.empty()) build_csr();
 }
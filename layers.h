@@ -3,61 +3,189 @@
 #include <random>
 #include <vector>
 
+/* ───────── Mode reproductible ──────────────────────────────────── */
+/*  Les réductions entre tranches parallèles (dx et dW de la convolution)
+ *  se font par blocs de forme fixe — un canal de sortie en CHW, DET_ROWS
+ *  lignes en HWC — combinés en arbre binaire fixe. Ni le nombre de
+ *  threads, ni le vol de tâches, ni les réglages de l'autotuner ne
+ *  changent alors l'ordre des additions : pertes et poids identiques au
+ *  bit près. À régler hors de tout entraînement (global, non atomique
+ *  vis-à-vis d'un backward en cours).
+ */
+void set_deterministic(bool on);
+bool deterministic();
+
 /* ───────── Convolution (3×3, pad=1) ────────────────────────────── */
+/*  En HWC, convolution directe vectorisée sur les canaux de sortie :
+ *  chaque pixel d'entrée est diffusé et multiplié par un vecteur de
+ *  8 poids (un registre AVX pour outC = 8). Les poids sont alors aussi
+ *  rangés en Wv_ [outC/8][k*k][inC][8], recalculé après apply_gradients.
+ */
 class ConvLayer {
 public:
-    ConvLayer(int inC, int outC, int k, std::mt19937& g);
+    ConvLayer(int inC, int outC, int k, std::mt19937& g,
+              Layout layout = Layout::CHW);
 
-    Tensor forward (const Tensor& in);
+    Tensor forward (const Tensor& in);                 // entraînement (cache)
+    Tensor infer   (const Tensor& in) const;           // inférence, thread-safe
     Tensor backward(const Tensor& grad);               // ← lr retiré
     void   apply_gradients(int batch_sz, float lr);    // ← nouveau
 
+    int    in_channels()  const { return inC_; }
+    int    out_channels() const { return outC_; }
+    int    kernel()       const { return k_; }
+    Layout layout()       const { return layout_; }
+    float  weight(int oc, int ic, int tap) const { return W_[(oc * inC_ + ic) * k_ * k_ + tap]; }
+    float  bias  (int oc) const { return b_[oc]; }
+
+    /* réglages de l'autotuner : disposition (entre deux mini-lots) et
+       nombre de tranches des noyaux (0 : heuristique, 1 : en ligne) */
+    void   set_layout(Layout layout);
+    void   set_tasks(int tasks) { tasks_ = tasks; }
+    int    tasks() const        { return tasks_; }
+
+    /* échange le cache du forward (l'entrée) : plusieurs échantillons
+       en vol dans l'entraînement pipeliné (voir pipeline.h) */
+    void   swap_cache(Tensor& in) { cache_.swap(in); }
+
 private:
     int inC_, outC_, k_;
+    Layout layout_;
+    int    tasks_ = 0;
     Tensor W_, b_,             // poids
            dW_, db_,           // gradients instantanés
            gW_, gb_,           // cumul mini-lot
+           Wv_,                // poids HWC par panneaux de 8 canaux de sortie
            cache_;             // entrée mémorisée
 
     int idx(int c, int y, int x, int C, int H, int W) const;
+    int oc_panels() const { return (outC_ + 7) / 8; }
+    std::size_t wv(int oc, int ic, int tap) const
+    {
+        return ((static_cast<std::size_t>(oc / 8) * k_ * k_ + tap) * inC_ + ic) * 8 + oc % 8;
+    }
+    void   pack_hwc();
+    Tensor infer_hwc   (const Tensor& in) const;
+    Tensor backward_hwc(const Tensor& grad);
 };
 
 /* ───────── ReLU ────────────────────────────────────────────────── */
 class ReLU {
 public:
-    Tensor forward (const Tensor& in);
+    Tensor forward (const Tensor& in);                 // entraînement (cache)
+    Tensor infer   (const Tensor& in) const;           // inférence, thread-safe
     Tensor backward(const Tensor& grad);
     void   apply_gradients(int, float) {}              // stub vide
+    void   swap_cache(std::vector<uint8_t>& mask) { mask_.swap(mask); }
 private:
-    Tensor cache_;
+    std::vector<uint8_t> mask_;    // 1 bit / élément : entrée > 0
 };
 
 /* ───────── 2×2 MaxPool ─────────────────────────────────────────── */
 class MaxPool {
 public:
-    Tensor forward (const Tensor& in);
+    explicit MaxPool(Layout layout = Layout::CHW) : layout_(layout) {}
+    void set_layout(Layout layout) { layout_ = layout; }
+
+    Tensor forward (const Tensor& in);                 // entraînement (cache)
+    Tensor infer   (const Tensor& in) const;           // inférence, thread-safe
     Tensor backward(const Tensor& grad);
     void   apply_gradients(int, float) {}              // stub vide
+
+    /* échange les codes du forward ; les dimensions s'en déduisent
+       (entrée IMG_SIZE × IMG_SIZE, un mot par ligne de sortie) */
+    void   swap_cache(std::vector<uint32_t>& code)
+    {
+        code_.swap(code);
+        H_ = W_ = IMG_SIZE / 2;
+        C_ = static_cast<int>(code_.size()) / H_;
+    }
 private:
+    Layout layout_;
     int C_, H_, W_;
-    std::vector<int> argmax_;
+    std::vector<uint32_t> code_;   // 2 bits / sortie (py*2+px), 1 mot / ligne
     int idx(int c, int y, int x, int C, int H, int W) const;
+    void pool(const Tensor& in, Tensor& out, uint32_t* code,
+              int C, int H, int W) const;
+    void pool_hwc(const Tensor& in, Tensor& out, uint32_t* code,
+                  int C, int H, int W) const;
 };
 
 /* ───────── Fully-connected ─────────────────────────────────────── */
+/* coût d'une inférence (1 échantillon) des couches denses */
+struct DenseCost {
+    double flops  = 0.0;       // mul + add réellement exécutés
+    double bytes  = 0.0;       // poids + index lus
+    double blocks = 0.0, zero_blocks = 0.0;
+
+    DenseCost& operator+=(const DenseCost& o)
+    {
+        flops += o.flops; bytes += o.bytes;
+        blocks += o.blocks; zero_blocks += o.zero_blocks;
+        return *this;
+    }
+};
+
+/*  Poids rangés en panneaux de PANEL sorties : pour chaque entrée i,
+ *  les PANEL poids W[o..o+PANEL)[i] sont contigus => forward et dW
+ *  avancent d'un vecteur SIMD par entrée. Le backward-data (W^T g)
+ *  lit une copie transposée, elle aussi en panneaux (de PANEL entrées),
+ *  reconstruite paresseusement au premier backward après apply_gradients.
+ */
 class Dense {
 public:
+    static constexpr int PANEL = 8;
+
     Dense(int inD, int outD, std::mt19937& g);
 
-    Tensor forward (const Tensor& in);
+    Tensor forward (const Tensor& in);                 // entraînement (cache)
+    Tensor infer   (const Tensor& in) const;           // inférence, thread-safe
     Tensor backward(const Tensor& grad);               // ← lr retiré
     void   apply_gradients(int batch_sz, float lr);    // ← nouveau
 
+    int   in_dim()  const { return inD_; }
+    int   out_dim() const { return outD_; }
+    float weight(int o, int i) const { return W_[wp(o, i)]; }
+    float bias  (int o)        const { return b_[o]; }
+
+    /* réordonne les entrées : nouvelle entrée i = ancienne entrée src[i]
+       (ex. aplatissement HWC au lieu de CHW devant la couche) */
+    void  permute_inputs(const std::vector<int>& src);
+
+    /* élagage par magnitude : annule, dans chaque panneau, la fraction
+       `sparsity` des blocs (PANEL sorties × 1 entrée) de plus faible
+       norme — toutes les sorties gardent autant d'entrées. Les blocs annulés
+       le restent pendant le réglage fin ; l'inférence passe alors par
+       un CSR par blocs (bptr_/bcol_/bval_) qui ne lit que les autres. */
+    void      prune(float sparsity);
+    DenseCost cost() const;
+
+    /* X : n lignes de inD_ ; renvoie n lignes de outD_ */
+    Tensor infer_batch(const Tensor& X, int n) const;
+
+    /* nombre de tranches des noyaux (autotuner ; 0 : heuristique) */
+    void set_tasks(int tasks) { tasks_ = tasks; }
+    int  tasks() const        { return tasks_; }
+
 private:
     int inD_, outD_;
-    Tensor W_, b_,
-           dW_, db_,
-           gW_, gb_,
+    int tasks_ = 0;
+    int P_, Q_;                // panneaux de sorties / d'entrées
+    Tensor W_, b_,             // [P_][inD_][PANEL], biais complété à P_*PANEL
+           gW_, gb_,           // cumul mini-lot (même disposition)
+           WT_,                // [Q_][outD_][PANEL] : transposée pour dx
            cache_;
+    bool   wt_stale_ = true;
+
+    std::vector<uint8_t> keep_;        // [P_][inD_] bloc conservé (vide : dense)
+    std::vector<int>     bptr_, bcol_; // CSR par blocs : [P_+1], [nnzb]
+    Tensor               bval_;        // [nnzb][PANEL]
+
+    std::size_t wp(int o, int i) const
+    {
+        return (static_cast<std::size_t>(o / PANEL) * inD_ + i) * PANEL + o % PANEL;
+    }
+    void pack_transpose();
+    void build_csr();
 };
 
@@ -1,29 +1,157 @@
 #include <iostream>
 #include "mnist_loader.h"
+#include "autotune.h"
+#include "cascade.h"
 #include "cnn.h"
+#include "codegen.h"
+#include "denseNN.h"
+#include "pruning.h"
+#include "sweep.h"
+#include "thread_pool.h"
 #include "training.h"
+#include <fstream>
+#include <iterator>
 #include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
-constexpr const char* TRAIN_IMAGES = "D:\\mnist\\train-images.idx3-ubyte";
-constexpr const char* TRAIN_LABELS = "D:\\mnist\\train-labels.idx1-ubyte";
-constexpr const char* TEST_IMAGES = "D:\\mnist\\t10k-images.idx3-ubyte";
-constexpr const char* TEST_LABELS = "D:\\mnist\\t10k-labels.idx1-ubyte";
+/*  Usage : mnist [data_dir] [train_images train_labels]...
+ *    data_dir : dossier des fichiers IDX MNIST (défaut : data),
+ *               bruts ou compressés (.gz)
+ *    paires supplémentaires : fragments d'entraînement (remplacent
+ *               train-images/train-labels de data_dir)
+ */
+constexpr const char* DEFAULT_DATA = "data";
+constexpr const char* TRAIN_IMAGES = "train-images-idx3-ubyte";
+constexpr const char* TRAIN_LABELS = "train-labels-idx1-ubyte";
+constexpr const char* TEST_IMAGES = "t10k-images-idx3-ubyte";
+constexpr const char* TEST_LABELS = "t10k-labels-idx1-ubyte";
 
 constexpr int   EPOCHS = 6;
 constexpr float LR = 0.01f;
 constexpr int    BATCH_SIZE = 32;   // taille du mini-lot
+constexpr bool   AUGMENT = false;   // décalages / rotations / distorsions à la volée
+constexpr int    SHUFFLE_BUFFER = 16384;   // images (uint8) gardées pour le mélange
+constexpr int    THREADS = 0;       // workers du moteur (0 : tous les cœurs)
+constexpr bool   PIN_THREADS = false;   // épinglage des workers (ordre NUMA)
+constexpr bool   DETERMINISTIC = false; // résultats bit à bit indépendants du nombre de threads
+constexpr bool   PIPELINE = false;  // CNN : étages conv / dense / backward concurrents
+constexpr int    PATIENCE = 0;      // arrêt après N époques sans progrès (0 : jamais)
+constexpr Layout LAYOUT = Layout::CHW;  // HWC : conv vectorisée, reproductible entre machines seulement avec DETERMINISTIC
+constexpr bool   DENSE_MODEL = false;   // DenseNN tout connecté au lieu du CNN
+constexpr bool   CASCADE = false;   // entraîne les deux modèles, calibre la cascade
+constexpr bool   PRUNE = false;     // élagage progressif + rapport après l'entraînement
+constexpr int    PRUNE_FINETUNE = 1;    // époques de réglage fin par niveau
+const std::vector<float> PRUNE_LEVELS = { 0.5f, 0.7f, 0.8f, 0.9f, 0.95f };
+const std::vector<float> CASCADE_THRESHOLDS = { 0.f, 0.5f, 0.8f, 0.9f, 0.95f, 0.98f, 0.99f, 0.995f, 0.999f, 2.f };
+constexpr const char* EXPORT_CPP = "";   // si non vide : inférence C++ autonome générée
+constexpr const char* TUNE_CACHE = "";   // si non vide : noyaux mesurés par machine (ex. "autotune.cache")
+constexpr bool   TUNE_LAYOUT = false;   // l'autotuner peut remplacer LAYOUT
 
+/* balayage : K modèles dans ce processus, jeu chargé une seule fois */
+constexpr bool SWEEP = false;
+constexpr int  SWEEP_THREADS = 0;   // budget de cœurs (0 : tous)
+const std::vector<SweepConfig> SWEEP_CONFIGS = {
+    /* dense   lr     lot  époques */
+    { false, 0.01f,  32, EPOCHS },
+    { false, 0.02f,  32, EPOCHS },
+    { false, 0.01f,  64, EPOCHS },
+    { false, 0.05f, 128, EPOCHS },
+    { true,  0.01f,  32, EPOCHS },
+    { true,  0.05f,  32, EPOCHS },
+};
 
-int main() {
+
+/* fichier brut s'il existe, sinon sa version .gz */
+static std::string resolve(const std::string& dir, const std::string& name)
+{
+    const std::string p = dir + "/" + name;
+    return std::ifstream(p).good() ? p : p + ".gz";
+}
+
+/* fragments d'entraînement concaténés en mémoire */
+static void load_train(const std::vector<IdxShard>& shards, Images& Xtr, Labels& Ytr)
+{
+    for (const IdxShard& s : shards) {
+        Images X = load_images(s.images);
+        Labels Y = load_labels(s.labels);
+        Xtr.insert(Xtr.end(), std::make_move_iterator(X.begin()), std::make_move_iterator(X.end()));
+        Ytr.insert(Ytr.end(), Y.begin(), Y.end());
+    }
+}
+
+/* entraînement en flux, puis élagage (optionnel) */
+template <class Net>
+static void run(Net& net, const std::vector<IdxShard>& shards,
+                const Images& Xte, const Labels& Yte)
+{
+    if (*TUNE_CACHE) {
+        const TuneStats t = autotune(net, TUNE_CACHE, TUNE_LAYOUT);
+        std::cout << "autotune : " << t.measured << " couche(s) mesuree(s), "
+                  << t.cached << " lue(s) dans " << TUNE_CACHE << "\n";
+    }
+
+    AugmentParams aug;
+    IdxStream train(shards, BATCH_SIZE, SHUFFLE_BUFFER, 42u,
+                    AUGMENT ? &aug : nullptr);
+    train_epoch_loop(net, train, Xte, Yte, EPOCHS,
+                     PATIENCE > 0 ? patience_stop(PATIENCE) : EarlyStop{});
+
+    if (PRUNE) {
+        /* le réglage fin indexe le jeu d'entraînement : chargé en mémoire */
+        Images Xtr;
+        Labels Ytr;
+        load_train(shards, Xtr, Ytr);
+        prune_report(net, Xtr, Ytr, Xte, Yte, PRUNE_LEVELS, PRUNE_FINETUNE, BATCH_SIZE);
+    }
+
+    if (*EXPORT_CPP) {
+        std::ofstream out(EXPORT_CPP);
+        emit_cpp(net, out);
+        if (!out) throw std::runtime_error(std::string("Cannot write ") + EXPORT_CPP);
+    }
+}
+
+int main(int argc, char** argv) {
     try {
-        Images Xtr = load_images(TRAIN_IMAGES);
-        Labels Ytr = load_labels(TRAIN_LABELS);
-        Images Xte = load_images(TEST_IMAGES);
-        Labels Yte = load_labels(TEST_LABELS);
+        const std::string dir = argc > 1 ? argv[1] : DEFAULT_DATA;
+        ThreadPool::configure({ THREADS, PIN_THREADS, {} });
+        set_deterministic(DETERMINISTIC);
+
+        std::vector<IdxShard> shards;
+        for (int a = 2; a + 1 < argc; a += 2)
+            shards.push_back({ argv[a], argv[a + 1] });
+        if (shards.empty())
+            shards.push_back({ resolve(dir, TRAIN_IMAGES), resolve(dir, TRAIN_LABELS) });
+
+        Images Xte = load_images(resolve(dir, TEST_IMAGES));
+        Labels Yte = load_labels(resolve(dir, TEST_LABELS));
 
         std::mt19937 gen(42);
-        CNN net(LR, gen);
-        train_epoch_loop(net, Xtr, Ytr, Xte, Yte, EPOCHS, BATCH_SIZE);
+        if (SWEEP) {
+            Images Xtr;
+            Labels Ytr;
+            load_train(shards, Xtr, Ytr);
+            print_sweep(run_sweep(Xtr, Ytr, Xte, Yte, SWEEP_CONFIGS, SWEEP_THREADS, LAYOUT));
+        }
+        else if (CASCADE) {
+            DenseNN fast(LR, gen);
+            CNN     slow(LR, gen, LAYOUT);
+            slow.set_pipelined(PIPELINE);
+            run(fast, shards, Xte, Yte);
+            run(slow, shards, Xte, Yte);
+            calibrate_cascade(fast, slow, Xte, Yte, CASCADE_THRESHOLDS);
+        }
+        else if (DENSE_MODEL) {
+            DenseNN net(LR, gen);
+            run(net, shards, Xte, Yte);
+        }
+        else {
+            CNN net(LR, gen, LAYOUT);
+            net.set_pipelined(PIPELINE);
+            run(net, shards, Xte, Yte);
+        }
 
     }
     catch (const std::exception& ex) {
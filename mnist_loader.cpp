@@ -1,39 +1,31 @@
 #include "mnist_loader.h"
-#include <fstream>
+#include "idx_stream.h"
 #include <stdexcept>
 
-static uint32_t swap_endian(uint32_t v) {
-    return  (v >> 24) |
-        ((v >> 8) & 0xFF00) |
-        ((v << 8) & 0xFF0000) |
-        (v << 24);
-}
-
+/*  Chargement complet en mémoire (jeu de test, petits jeux) ;
+ *  fichiers IDX bruts ou compressés (.gz) via IdxReader.
+ *  Pour l'entraînement hors mémoire, voir IdxStream.
+ */
 Images load_images(const std::string& path) {
-    std::ifstream f(path, std::ios::binary);
-    if (!f) throw std::runtime_error("Cannot open " + path);
-
-    uint32_t m, n, r, c;
-    f.read((char*)&m, 4); f.read((char*)&n, 4);
-    f.read((char*)&r, 4); f.read((char*)&c, 4);
-    m = swap_endian(m); n = swap_endian(n);
-    r = swap_endian(r); c = swap_endian(c);
-    if (m != 2051 || r != 28 || c != 28) throw std::runtime_error("bad image file");
+    IdxReader f(path);
+    if (f.magic() != 0x803 || f.dims_count() != 3 ||
+        f.dim(1) != 28 || f.dim(2) != 28) throw std::runtime_error("bad image file");
 
-    Images imgs(n, Tensor(r * c));
+    const uint32_t n = f.count();
+    const std::size_t rc = f.record_size();
+    Images imgs(n, Tensor(rc));
+    std::vector<unsigned char> buf(rc);
     for (uint32_t i = 0; i < n; ++i) {
-        std::vector<unsigned char> buf(r * c);
-        f.read((char*)buf.data(), r * c);
+        f.read(buf.data(), 1);
         for (size_t j = 0; j < buf.size(); ++j) imgs[i][j] = buf[j] / 255.0f;
     }
     return imgs;
 }
 Labels load_labels(const std::string& path) {
-    std::ifstream f(path, std::ios::binary);
-    if (!f) throw std::runtime_error("Cannot open " + path);
-    uint32_t m, n; f.read((char*)&m, 4); f.read((char*)&n, 4);
-    m = swap_endian(m); n = swap_endian(n);
-    if (m != 2049) throw std::runtime_error("bad label file");
-    Labels lbl(n); f.read((char*)lbl.data(), n);
+    IdxReader f(path);
+    if (f.magic() != 0x801) throw std::runtime_error("bad label file");
+    Labels lbl(f.count()); f.read(lbl.data(), lbl.size());
+    for (Label y : lbl)
+        if (y >= NUM_CLASSES) throw std::runtime_error("label out of range");
     return lbl;
 }
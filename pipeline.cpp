@@ -0,0 +1,208 @@
+#include "pipeline.h"
+#include "cnn.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__i386__)
+  #include <immintrin.h>
+  #define RN_PAUSE() _mm_pause()
+#else
+  #define RN_PAUSE() std::this_thread::yield()
+#endif
+
+/* ───────── Attente sur les files ───────────────────────────────── */
+/*  Attente active courte (un étage suit l'autre de quelques µs), puis
+    cession du cœur : indispensable quand les étages partagent un cœur. */
+static void backoff(int spin)
+{
+    if (spin < 64) RN_PAUSE();
+    else           std::this_thread::yield();
+}
+
+/* levée dans un étage qui attend sur une file fermée */
+struct Closed {};
+
+template <class Q>
+static int pop_wait(Q& q, const std::atomic<bool>& closed)
+{
+    int v;
+    for (int spin = 0; !q.try_pop(v); ++spin) {
+        if (closed.load(std::memory_order_acquire)) throw Closed{};
+        backoff(spin);
+    }
+    return v;
+}
+
+template <class Q>
+static void push_wait(Q& q, int v, const std::atomic<bool>& closed)
+{
+    for (int spin = 0; !q.try_push(v); ++spin) {
+        if (closed.load(std::memory_order_acquire)) throw Closed{};
+        backoff(spin);
+    }
+}
+
+/* ───────── Cycle de vie ────────────────────────────────────────── */
+TrainPipeline::TrainPipeline()
+{
+    for (int s = 0; s < SLOTS; ++s) free_.try_push(s);
+    for (int stage = 0; stage < 2; ++stage)
+        threads_.emplace_back(&TrainPipeline::stage_loop, this, stage);
+}
+
+TrainPipeline::~TrainPipeline()
+{
+    {
+        std::lock_guard<std::mutex> lk(m_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    for (std::thread& t : threads_) t.join();
+}
+
+/* étages 0 et 1 : un réveil par lot */
+void TrainPipeline::stage_loop(int stage)
+{
+    unsigned seen = 0;
+    for (;;) {
+        int n;
+        {
+            std::unique_lock<std::mutex> lk(m_);
+            cv_.wait(lk, [&] { return stop_ || generation_ != seen; });
+            if (stop_) return;
+            seen = generation_;
+            n    = static_cast<int>(idx_->size());
+        }
+        try {
+            if (stage == 0) features(n);
+            else            classifier(n);
+        }
+        catch (const Closed&) {}
+        catch (...) { fail(std::current_exception()); }
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            --pending_;
+        }
+        cv_.notify_all();
+    }
+}
+
+float TrainPipeline::run(CNN& net, const Images& X, const Labels& Y,
+                         const std::vector<int>& batch_idx)
+{
+    std::lock_guard<std::mutex> run_lk(run_m_);
+    pool_fwd_.set_layout(net.layout());
+    pool_back_.set_layout(net.layout());
+    {
+        std::lock_guard<std::mutex> lk(m_);
+        net_ = &net; X_ = &X; Y_ = &Y; idx_ = &batch_idx;
+        pending_ = 2;
+        ++generation_;
+    }
+    cv_.notify_all();
+
+    float loss_sum = 0.f;
+    try {
+        loss_sum = backprop(static_cast<int>(batch_idx.size()));
+    }
+    catch (const Closed&) {}
+    catch (...) { fail(std::current_exception()); }
+
+    std::unique_lock<std::mutex> lk(m_);
+    cv_.wait(lk, [&] { return pending_ == 0; });
+    if (error_) {
+        /* tous les étages sont à l'arrêt : état remis à neuf pour le lot suivant */
+        std::exception_ptr e = error_;
+        error_ = nullptr;
+        closed_.store(false, std::memory_order_relaxed);
+        free_.clear(); to_fc_.clear(); to_back_.clear();
+        for (int s = 0; s < SLOTS; ++s) free_.try_push(s);
+        std::rethrow_exception(e);
+    }
+    return loss_sum;
+}
+
+void TrainPipeline::fail(std::exception_ptr e)
+{
+    {
+        std::lock_guard<std::mutex> lk(m_);
+        if (!error_) error_ = e;
+    }
+    closed_.store(true, std::memory_order_release);
+}
+
+/* ───────── Étages ──────────────────────────────────────────────── */
+/* 0 : conv → relu → pool ; la conv passe par infer(), son entrée
+       voyage dans l'emplacement jusqu'au backward */
+void TrainPipeline::features(int n)
+{
+    const ConvLayer& conv = net_->conv();
+    for (int k = 0; k < n; ++k) {
+        const int s = pop_wait(free_, closed_);
+        Slot& slot = slots_[s];
+        const Tensor& img = (*X_)[(*idx_)[k]];
+        slot.x.assign(img.begin(), img.end());
+
+        slot.feat = pool_fwd_.forward(relu_fwd_.forward(conv.infer(slot.x)));
+        relu_fwd_.swap_cache(slot.mask);
+        pool_fwd_.swap_cache(slot.code);
+        push_wait(to_fc_, s, closed_);
+    }
+}
+
+/* 1 : couche dense et soft-max (mêmes opérations que CNN::train_one) */
+void TrainPipeline::classifier(int n)
+{
+    Dense& fc = net_->fc();
+    for (int k = 0; k < n; ++k) {
+        const int s = pop_wait(to_fc_, closed_);
+        Slot& slot = slots_[s];
+        const Label y = (*Y_)[(*idx_)[k]];
+
+        Tensor logits = fc.forward(slot.feat);
+
+        float maxv = *std::max_element(logits.begin(), logits.end());
+        Tensor p(logits.size());
+        float  sum = 0.f;
+        for (size_t i = 0; i < logits.size(); ++i) {
+            p[i] = std::exp(logits[i] - maxv);
+            sum += p[i];
+        }
+        for (float& v : p) v /= sum;
+        slot.loss = -std::log(std::max(1e-7f, p[y]));
+
+        Tensor d_logits(p.size());
+        for (size_t i = 0; i < p.size(); ++i)
+            d_logits[i] = p[i] - (i == static_cast<size_t>(y) ? 1.f : 0.f);
+
+        slot.grad = fc.backward(d_logits);
+        push_wait(to_back_, s, closed_);
+    }
+}
+
+/* 2 : pool → relu → conv, caches prêtés par l'emplacement puis rendus */
+float TrainPipeline::backprop(int n)
+{
+    ConvLayer& conv = net_->conv();
+    float loss_sum = 0.f;
+    for (int k = 0; k < n; ++k) {
+        const int s = pop_wait(to_back_, closed_);
+        Slot& slot = slots_[s];
+
+        pool_back_.swap_cache(slot.code);
+        Tensor d_pool = pool_back_.backward(slot.grad);
+        pool_back_.swap_cache(slot.code);
+
+        relu_back_.swap_cache(slot.mask);
+        Tensor d_relu = relu_back_.backward(d_pool);
+        relu_back_.swap_cache(slot.mask);
+
+        conv.swap_cache(slot.x);
+        conv.backward(d_relu);
+        conv.swap_cache(slot.x);
+
+        loss_sum += slot.loss;
+        push_wait(free_, s, closed_);
+    }
+    return loss_sum;
+}
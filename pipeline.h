@@ -0,0 +1,127 @@
+#pragma once
+#include "layers.h"
+#include "tensor.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class CNN;
+
+/* ───────── File SPSC sans verrou ───────────────────────────────── */
+/*  Un seul producteur, un seul consommateur, capacité N (puissance
+ *  de 2). Les deux indices croissent sans fin ; chacun n'est écrit que
+ *  par son côté, publié en release et lu en acquire par l'autre.
+ */
+template <class T, std::size_t N>
+class SpscQueue {
+    static_assert((N & (N - 1)) == 0, "capacité SPSC : puissance de 2");
+public:
+    bool try_push(const T& v)
+    {
+        const std::size_t h = head_.load(std::memory_order_relaxed);
+        if (h - tail_.load(std::memory_order_acquire) == N) return false;   // pleine
+        buf_[h % N] = v;
+        head_.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(T& v)
+    {
+        const std::size_t t = tail_.load(std::memory_order_relaxed);
+        if (t == head_.load(std::memory_order_acquire)) return false;       // vide
+        v = buf_[t % N];
+        tail_.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /* vide la file ; sans producteur ni consommateur actif */
+    void clear()
+    {
+        head_.store(0, std::memory_order_relaxed);
+        tail_.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    alignas(64) std::atomic<std::size_t> head_{ 0 };     // écrit par le producteur
+    alignas(64) std::atomic<std::size_t> tail_{ 0 };     // écrit par le consommateur
+    T buf_[N];
+};
+
+/* ───────── Entraînement pipeliné du CNN ────────────────────────── */
+/*  Les échantillons d'un mini-lot traversent trois étages concurrents,
+ *  reliés par des files SPSC :
+ *    0. conv → relu → pool (forward)               thread dédié
+ *    1. dense forward, soft-max, dense backward    thread dédié
+ *    2. pool → relu → conv (backward)              thread appelant
+ *  L'échantillon i+2 est convolué pendant que i+1 traverse la couche
+ *  dense et que i remonte la convolution. Chaque étage garde les
+ *  noyaux parallèles de ses couches : le pool global sert l'étage qui
+ *  le prend en premier, les autres s'exécutent en ligne.
+ *
+ *  Les caches de chaque échantillon (entrée, masque ReLU, codes pool)
+ *  voyagent dans un emplacement parmi SLOTS, recyclé par une troisième
+ *  file (étage 2 → étage 0). Les poids ne changent pas pendant le lot
+ *  et chaque couche accumule ses gradients dans un seul étage, dans
+ *  l'ordre des échantillons : résultats identiques au bit près à
+ *  CNN::train_batch séquentiel (avec un pool de plusieurs threads, en
+ *  mode reproductible seulement : voir set_deterministic).
+ *
+ *  Si un étage lève une exception, les files sont fermées : les autres
+ *  étages sortent de leur attente, run() attend qu'ils aient tous
+ *  rendu la main, remet files et emplacements à neuf puis relance la
+ *  première exception.
+ */
+class TrainPipeline {
+public:
+    TrainPipeline();
+    ~TrainPipeline();
+
+    TrainPipeline(const TrainPipeline&)            = delete;
+    TrainPipeline& operator=(const TrainPipeline&) = delete;
+
+    /* accumule les gradients du lot dans conv/fc ; renvoie Σ pertes */
+    float run(CNN& net, const Images& X, const Labels& Y,
+              const std::vector<int>& batch_idx);
+
+private:
+    static constexpr int SLOTS = 8;
+
+    struct Slot {
+        Tensor                x, feat, grad;   // entrée, sortie pool, gradient vers pool
+        std::vector<uint8_t>  mask;            // cache ReLU
+        std::vector<uint32_t> code;            // cache MaxPool
+        float                 loss = 0.f;
+    };
+
+    void stage_loop(int stage);
+    void fail(std::exception_ptr e);           // garde la 1re erreur, ferme les files
+    void features(int n);                      // étage 0
+    void classifier(int n);                    // étage 1
+    float backprop(int n);                     // étage 2
+
+    std::mutex run_m_;                         // un lot à la fois
+
+    Slot                       slots_[SLOTS];
+    SpscQueue<int, SLOTS>      free_, to_fc_, to_back_;
+    std::atomic<bool>          closed_{ false };   // files fermées après une erreur
+    ReLU                       relu_fwd_, relu_back_;
+    MaxPool                    pool_fwd_, pool_back_;
+
+    /* lot courant (lu par les étages après le réveil) */
+    CNN*                    net_ = nullptr;
+    const Images*           X_   = nullptr;
+    const Labels*           Y_   = nullptr;
+    const std::vector<int>* idx_ = nullptr;
+
+    std::vector<std::thread> threads_;
+    std::mutex               m_;
+    std::condition_variable  cv_;
+    unsigned                 generation_ = 0;
+    int                      pending_    = 0;  // étages dédiés encore actifs
+    bool                     stop_       = false;
+    std::exception_ptr       error_;           // première exception d'un étage
+};
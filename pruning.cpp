@@ -0,0 +1,57 @@
+#include "pruning.h"
+#include "cnn.h"
+#include "denseNN.h"
+#include "training.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+#include <random>
+
+static void print_row(const char* tag, const DenseCost& c, const DenseCost& ref, double acc)
+{
+    std::printf("%-8s %7.1f%% %9.3f %9.1f %7.2fx %9.2f%%\n", tag,
+                100.0 * c.zero_blocks / c.blocks, c.flops * 1e-6, c.bytes / 1024.0,
+                ref.flops / c.flops, acc);
+}
+
+template <class Net>
+void prune_report(Net& net,
+                  const Images& Xtr, const Labels& Ytr,
+                  const Images& Xte, const Labels& Yte,
+                  const std::vector<float>& levels,
+                  int finetune_epochs,
+                  int batch_size)
+{
+    std::vector<int> idx(Xtr.size());
+    std::iota(idx.begin(), idx.end(), 0);
+    std::mt19937 gen(42);
+
+    const DenseCost ref = net.dense_cost();
+    std::printf("%-8s %8s %9s %9s %8s %10s\n",
+                "niveau", "blocs=0", "MFLOP/img", "Ko/img", "gain", "test");
+    print_row("dense", ref, ref, test_accuracy(net, Xte, Yte));
+
+    for (float s : levels) {
+        net.prune(s);
+
+        /* ---- réglage fin : les blocs élagués restent nuls ---- */
+        for (int ep = 0; ep < finetune_epochs; ++ep) {
+            std::shuffle(idx.begin(), idx.end(), gen);
+            for (std::size_t pos = 0; pos < idx.size(); pos += batch_size) {
+                std::size_t end = std::min(pos + batch_size, idx.size());
+                std::vector<int> batch_idx(idx.begin() + pos, idx.begin() + end);
+                net.train_batch(Xtr, Ytr, batch_idx, static_cast<int>(batch_idx.size()));
+            }
+        }
+
+        char tag[16];
+        std::snprintf(tag, sizeof tag, "%.0f%%", 100.0 * s);
+        print_row(tag, net.dense_cost(), ref, test_accuracy(net, Xte, Yte));
+    }
+}
+
+template void prune_report<CNN>    (CNN&,     const Images&, const Labels&, const Images&, const Labels&,
+                                    const std::vector<float>&, int, int);
+template void prune_report<DenseNN>(DenseNN&, const Images&, const Labels&, const Images&, const Labels&,
+                                    const std::vector<float>&, int, int);
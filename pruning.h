@@ -0,0 +1,21 @@
+#pragma once
+#include "tensor.h"
+#include <vector>
+
+/* ───────── Élagage progressif + compte rendu ───────────────────── */
+/*  Pour chaque niveau de `levels` (croissants, fraction de blocs nuls) :
+ *  élague les couches denses de `net` par magnitude, réentraîne
+ *  `finetune_epochs` époques via train_batch (0 : sans réglage fin),
+ *  puis affiche parcimonie, coût par inférence des couches denses
+ *  (FLOPs, octets lus) et précision de test. Une ligne « dense » de
+ *  référence précède les niveaux ; `net` reste élagué au dernier.
+ *
+ *  Net : CNN ou DenseNN.
+ */
+template <class Net>
+void prune_report(Net& net,
+                  const Images& Xtr, const Labels& Ytr,
+                  const Images& Xte, const Labels& Yte,
+                  const std::vector<float>& levels,
+                  int finetune_epochs,
+                  int batch_size);
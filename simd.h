@@ -0,0 +1,11 @@
+#pragma once
+
+/* SIMD : AVX2 si le compilateur l'active (/arch:AVX2, -mavx2),
+   sinon SSE2 (toujours présent en x64), sinon repli scalaire. */
+#if defined(__AVX2__)
+  #define RN_AVX2
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #define RN_SSE2
+  #include <immintrin.h>
+#endif
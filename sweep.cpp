@@ -0,0 +1,132 @@
+#include "sweep.h"
+#include "cnn.h"
+#include "denseNN.h"
+#include "thread_pool.h"
+#include "training.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <thread>
+
+using Clock = std::chrono::steady_clock;
+
+template <class Net> Net make_net(float lr, std::mt19937& g, Layout layout);
+template <> CNN     make_net<CNN>    (float lr, std::mt19937& g, Layout layout) { return CNN(lr, g, layout); }
+template <> DenseNN make_net<DenseNN>(float lr, std::mt19937& g, Layout)        { return DenseNN(lr, g); }
+
+/* un modèle, ordres d'époque partagés */
+template <class Net>
+static SweepResult train_one_config(const SweepConfig& c,
+                                    const Images& Xtr, const Labels& Ytr,
+                                    const Images& Xte, const Labels& Yte,
+                                    const std::vector<std::vector<int>>& orders,
+                                    Layout layout)
+{
+    const auto t0 = Clock::now();
+    std::mt19937 gen(42);
+    Net net = make_net<Net>(c.lr, gen, layout);
+
+    double loss_sum = 0.0;
+    for (int ep = 0; ep < c.epochs; ++ep)
+        loss_sum = train_epoch(net, Xtr, Ytr, orders[ep], c.batch_size);
+
+    SweepResult r{ c, loss_sum / static_cast<double>(Xtr.size()), test_accuracy(net, Xte, Yte), 0.0 };
+    r.seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+    return r;
+}
+
+std::vector<SweepResult> run_sweep(const Images& Xtr, const Labels& Ytr,
+                                   const Images& Xte, const Labels& Yte,
+                                   const std::vector<SweepConfig>& configs,
+                                   int threads,
+                                   Layout layout)
+{
+    if (configs.empty()) return {};
+    if (threads <= 0) threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    /* ordres d'époque communs (N entiers par époque) */
+    int max_epochs = 0;
+    for (const SweepConfig& c : configs) max_epochs = std::max(max_epochs, c.epochs);
+    std::vector<std::vector<int>> orders(max_epochs, std::vector<int>(Xtr.size()));
+    {
+        std::vector<int> idx(Xtr.size());
+        std::iota(idx.begin(), idx.end(), 0);
+        std::mt19937 gen(42);
+        for (auto& o : orders) {
+            std::shuffle(idx.begin(), idx.end(), gen);
+            o = idx;
+        }
+    }
+
+    /* plus coûteux d'abord (le CNN coûte ~3× le DenseNN par image) */
+    std::vector<int> todo(configs.size());
+    std::iota(todo.begin(), todo.end(), 0);
+    auto cost = [&](int i) { return configs[i].epochs * (configs[i].dense ? 1.0 : 3.0); };
+    std::stable_sort(todo.begin(), todo.end(), [&](int a, int b) { return cost(a) > cost(b); });
+
+    /* voies : une par modèle en vol, chacune avec un pool privé qui se
+       partage les `threads` cœurs ; le pool global n'est pas modifié */
+    const int lanes = std::min<int>(threads, static_cast<int>(configs.size()));
+    const int spin  = ThreadPool::current().spin;
+
+    /* pool privé lié au thread de la voie, délié même sur exception */
+    struct LanePool {
+        std::unique_ptr<ThreadPool> pool;
+        explicit LanePool(const ThreadPool::Config& cfg) : pool(ThreadPool::create(cfg))
+        {
+            ThreadPool::bind(pool.get());
+        }
+        ~LanePool() { ThreadPool::bind(nullptr); }
+    };
+
+    std::vector<SweepResult>        results(configs.size());
+    std::vector<std::exception_ptr> errors(lanes);
+    std::atomic<int> next{ 0 };
+    auto lane = [&](int l) {
+        try {
+            const int share = threads / lanes + (l < threads % lanes ? 1 : 0);
+            LanePool own({ share, false, {}, spin });
+            for (int k; (k = next.fetch_add(1)) < static_cast<int>(todo.size()); ) {
+                const SweepConfig& c = configs[todo[k]];
+                results[todo[k]] = c.dense
+                    ? train_one_config<DenseNN>(c, Xtr, Ytr, Xte, Yte, orders, layout)
+                    : train_one_config<CNN>    (c, Xtr, Ytr, Xte, Yte, orders, layout);
+                std::printf("  [%d/%zu] %s lr=%g batch=%d epochs=%d : %.2f%%\n",
+                            k + 1, todo.size(), c.dense ? "DenseNN" : "CNN", c.lr,
+                            c.batch_size, c.epochs, results[todo[k]].test_acc);
+            }
+        }
+        catch (...) {
+            errors[l] = std::current_exception();
+            next.store(static_cast<int>(todo.size()));      // plus de nouveau modèle
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int t = 1; t < lanes; ++t) pool.emplace_back(lane, t);
+    lane(0);
+    for (std::thread& t : pool) t.join();
+    for (const std::exception_ptr& e : errors)
+        if (e) std::rethrow_exception(e);
+
+    std::stable_sort(results.begin(), results.end(),
+                     [](const SweepResult& a, const SweepResult& b) { return a.test_acc > b.test_acc; });
+    return results;
+}
+
+void print_sweep(const std::vector<SweepResult>& results)
+{
+    std::printf("%4s %-9s %8s %6s %8s %9s %9s %9s\n",    // largeurs en octets (é)
+                "rang", "modèle", "lr", "lot", "époques", "perte", "test", "temps");
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const SweepResult& r = results[i];
+        std::printf("%4zu %-8s %8g %6d %7d %9.4f %8.2f%% %8.1fs\n",
+                    i + 1, r.cfg.dense ? "DenseNN" : "CNN", r.cfg.lr,
+                    r.cfg.batch_size, r.cfg.epochs, r.loss, r.test_acc, r.seconds);
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include "tensor.h"
+#include <vector>
+
+/* ───────── Balayage d'hyperparamètres en un seul processus ─────── */
+struct SweepConfig {
+    bool  dense;               // DenseNN (sinon CNN)
+    float lr;
+    int   batch_size;
+    int   epochs;
+};
+
+struct SweepResult {
+    SweepConfig cfg;
+    double      loss;          // perte moyenne de la dernière époque
+    double      test_acc;      // %
+    double      seconds;       // entraînement + évaluation
+};
+
+/*  Entraîne les K modèles sur un même jeu en mémoire, partagé en
+ *  lecture seule (aucune copie par modèle). L'ordre de chaque époque
+ *  est tiré une fois (graine 42, comme train_epoch_loop) et partagé :
+ *  un mini-lot n'est qu'une tranche de cet ordre, train_batch lit
+ *  directement X/Y.
+ *
+ *  Ordonnancement : `threads` cœurs au total (0 : tous), répartis en
+ *  min(threads, K) voies. Chaque voie tourne sur son propre thread
+ *  (la première sur l'appelant) avec un pool privé de threads / voies
+ *  cœurs, le reste de la division allant aux premières voies ; le
+ *  pool global n'est pas modifié. Les modèles les plus coûteux
+ *  partent en premier. `layout` : celle des CNN.
+ *  Si un modèle lève une exception, aucun autre ne démarre ; toutes
+ *  les voies sont jointes puis la première exception est relancée.
+ *  Renvoie les résultats triés par précision décroissante.
+ */
+std::vector<SweepResult> run_sweep(const Images& Xtr, const Labels& Ytr,
+                                   const Images& Xte, const Labels& Yte,
+                                   const std::vector<SweepConfig>& configs,
+                                   int threads = 0,
+                                   Layout layout = Layout::CHW);
+
+void print_sweep(const std::vector<SweepResult>& results);
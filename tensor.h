@@ -7,5 +7,14 @@ using Label = uint8_t;
 using Images = std::vector<Tensor>;
 using Labels = std::vector<Label>;
 
+struct Batch {                       // mini-lot autonome (augmenté / en flux)
+    Images           X;
+    Labels           Y;
+    std::vector<int> idx;            // 0..n-1 : indices dans X/Y
+};
+
+/* disposition des activations entre couches : C×H×W ou H×W×C (canaux contigus) */
+enum class Layout { CHW, HWC };
+
 constexpr int IMG_SIZE = 28;
 constexpr int NUM_CLASSES = 10;
@@ -0,0 +1,278 @@
+#include "thread_pool.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#if defined(_WIN32)
+  #define NOMINMAX
+  #include <windows.h>
+#elif defined(__linux__)
+  #include <pthread.h>
+  #include <sched.h>
+#endif
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__i386__)
+  #include <immintrin.h>
+  #define RN_PAUSE() _mm_pause()
+#else
+  #define RN_PAUSE() std::this_thread::yield()
+#endif
+
+/* ───────── Topologie ───────────────────────────────────────────── */
+/*  Liste des cœurs, nœud NUMA par nœud : avec T < nombre de cœurs,
+    les workers remplissent d'abord le nœud 0 au lieu de s'étaler. */
+static std::vector<int> numa_ordered_cpus()
+{
+    std::vector<int> cpus;
+#if defined(__linux__)
+    for (int node = 0; ; ++node) {
+        std::ifstream f("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        if (!f) break;
+        std::string list;
+        std::getline(f, list);
+        std::stringstream ss(list);
+        for (std::string item; std::getline(ss, item, ','); ) {
+            if (item.empty()) continue;
+            const std::size_t dash = item.find('-');
+            const int lo = std::stoi(item.substr(0, dash));
+            const int hi = dash == std::string::npos ? lo : std::stoi(item.substr(dash + 1));
+            for (int c = lo; c <= hi; ++c) cpus.push_back(c);
+        }
+    }
+#endif
+    if (cpus.empty()) {
+        const int n = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        for (int c = 0; c < n; ++c) cpus.push_back(c);
+    }
+    return cpus;
+}
+
+static void pin_current_thread(int cpu)
+{
+#if defined(_WIN32)
+    if (cpu < 64) SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu);
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)cpu;
+#endif
+}
+
+/* ───────── Pool global ─────────────────────────────────────────── */
+/*  Chaque noyau appelle instance() : pool lié au thread s'il y en a
+    un, sinon lecture d'un pointeur atomique ; le verrou ne sert qu'à
+    la création et à configure(). */
+static std::mutex                  g_pool_m;
+static std::unique_ptr<ThreadPool> g_pool;
+static std::atomic<ThreadPool*>    g_pool_ptr{ nullptr };
+static thread_local bool           tls_in_pool = false;
+static thread_local ThreadPool*    tls_bound   = nullptr;   // pool privé (bind)
+
+void ThreadPool::configure(const Config& cfg)
+{
+    std::lock_guard<std::mutex> lk(g_pool_m);
+    g_pool_ptr.store(nullptr, std::memory_order_release);
+    g_pool.reset();
+    g_pool.reset(new ThreadPool(cfg));
+    g_pool_ptr.store(g_pool.get(), std::memory_order_release);
+}
+
+ThreadPool& ThreadPool::instance()
+{
+    if (tls_bound) return *tls_bound;
+    if (ThreadPool* p = g_pool_ptr.load(std::memory_order_acquire)) return *p;
+    std::lock_guard<std::mutex> lk(g_pool_m);
+    if (!g_pool) {
+        g_pool.reset(new ThreadPool(Config{}));
+        g_pool_ptr.store(g_pool.get(), std::memory_order_release);
+    }
+    return *g_pool;
+}
+
+ThreadPool::Config ThreadPool::current()
+{
+    return instance().cfg_;
+}
+
+std::unique_ptr<ThreadPool> ThreadPool::create(const Config& cfg)
+{
+    return std::unique_ptr<ThreadPool>(new ThreadPool(cfg));
+}
+
+void ThreadPool::bind(ThreadPool* pool)
+{
+    tls_bound = pool;
+}
+
+ThreadPool::ThreadPool(const Config& cfg)
+    : cfg_(cfg)
+{
+    int n = cfg.threads > 0 ? cfg.threads
+                            : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    const std::vector<int> cpus = cfg.cpus.empty() ? numa_ordered_cpus() : cfg.cpus;
+
+    ranges_.reset(new Range[n]);
+    for (int tid = 1; tid < n; ++tid)
+        workers_.emplace_back(&ThreadPool::worker_loop, this, tid,
+                              cfg.pin ? cpus[tid % cpus.size()] : -1);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lk(m_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    for (std::thread& t : workers_) t.join();
+}
+
+/* ───────── Files de tranches ───────────────────────────────────── */
+int ThreadPool::pop_front(int w)
+{
+    uint64_t fb = ranges_[w].fb.load(std::memory_order_acquire);
+    for (;;) {
+        const uint32_t f = static_cast<uint32_t>(fb), b = static_cast<uint32_t>(fb >> 32);
+        if (f >= b) return -1;
+        if (ranges_[w].fb.compare_exchange_weak(fb, fb + 1, std::memory_order_acq_rel))
+            return static_cast<int>(f);
+    }
+}
+
+int ThreadPool::steal_back(int w)
+{
+    uint64_t fb = ranges_[w].fb.load(std::memory_order_acquire);
+    for (;;) {
+        const uint32_t f = static_cast<uint32_t>(fb), b = static_cast<uint32_t>(fb >> 32);
+        if (f >= b) return -1;
+        const uint64_t nfb = (static_cast<uint64_t>(b - 1) << 32) | f;
+        if (ranges_[w].fb.compare_exchange_weak(fb, nfb, std::memory_order_acq_rel))
+            return static_cast<int>(b - 1);
+    }
+}
+
+void ThreadPool::work(int tid)
+{
+    const int T = size();
+    for (;;) {
+        int c = pop_front(tid);
+        for (int k = 1; c < 0 && k < T; ++k)
+            c = steal_back((tid + k) % T);
+        if (c < 0) return;
+
+        const int lo = begin_ + c * grain_;
+        const int hi = std::min(end_, lo + grain_);
+        try {
+            fn_(ctx_, lo, hi, tid);
+        }
+        catch (...) {                              // relancée par run()
+            std::lock_guard<std::mutex> lk(error_m_);
+            if (!error_) error_ = std::current_exception();
+        }
+        remaining_.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
+
+/* ───────── Exécution ───────────────────────────────────────────── */
+constexpr uint64_t JOIN_OPEN  = uint64_t(1) << 32;
+constexpr uint64_t JOIN_COUNT = JOIN_OPEN - 1;
+
+static uint64_t join_tag(unsigned gen) { return static_cast<uint64_t>(gen & 0x7fffffffu) << 33; }
+
+/* attente de l'appelant : courte attente active, puis cession du cœur */
+static void backoff(int spin)
+{
+    if (spin < 256) RN_PAUSE();
+    else            std::this_thread::yield();
+}
+
+/* libère busy_ même si la tâche lève une exception */
+struct BusyGuard {
+    std::atomic<bool>& busy;
+    ~BusyGuard() { busy.store(false, std::memory_order_release); }
+};
+
+void ThreadPool::run(Fn fn, void* ctx, int begin, int end, int grain)
+{
+    if (end <= begin) return;
+    grain = std::max(1, grain);
+    const int chunks = (end - begin + grain - 1) / grain;
+
+    bool expected = false;
+    if (chunks <= 1 || workers_.empty() || tls_in_pool ||
+        !busy_.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+        fn(ctx, begin, end, 0);                               // inline
+        return;
+    }
+    BusyGuard guard{ busy_ };
+
+    /* seuls W threads reçoivent des tranches ; les autres files sont vides */
+    const int T = size(), W = std::min(T, chunks);
+    fn_ = fn; ctx_ = ctx;
+    begin_ = begin; end_ = end; grain_ = grain;
+    error_ = nullptr;
+    for (int w = 0; w < T; ++w) {
+        const uint64_t f = w < W ? static_cast<uint64_t>(chunks) * w / W : 0;
+        const uint64_t b = w < W ? static_cast<uint64_t>(chunks) * (w + 1) / W : 0;
+        ranges_[w].fb.store((b << 32) | f, std::memory_order_relaxed);
+    }
+    remaining_.store(chunks, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lk(m_);
+        const unsigned gen = generation_.load(std::memory_order_relaxed) + 1;
+        join_.store(join_tag(gen) | JOIN_OPEN, std::memory_order_release);
+        generation_.store(gen, std::memory_order_release);
+    }
+    for (int w = 1; w < W; ++w) cv_.notify_one();
+
+    tls_in_pool = true;
+    work(0);
+    tls_in_pool = false;
+
+    for (int spin = 0; remaining_.load(std::memory_order_acquire) > 0; ++spin) backoff(spin);
+
+    /* fermeture : plus aucun worker n'entre ; attente des seuls entrants */
+    join_.fetch_and(~JOIN_OPEN, std::memory_order_acq_rel);
+    for (int spin = 0; join_.load(std::memory_order_acquire) & JOIN_COUNT; ++spin) backoff(spin);
+
+    if (error_) std::rethrow_exception(error_);
+}
+
+/* entre dans la tâche de génération `gen` si elle est encore ouverte */
+bool ThreadPool::join(unsigned gen)
+{
+    uint64_t v = join_.load(std::memory_order_acquire);
+    for (;;) {
+        if ((v & ~JOIN_COUNT & ~JOIN_OPEN) != join_tag(gen) || !(v & JOIN_OPEN)) return false;
+        if (join_.compare_exchange_weak(v, v + 1, std::memory_order_acq_rel)) return true;
+    }
+}
+
+void ThreadPool::worker_loop(int tid, int cpu)
+{
+    if (cpu >= 0) pin_current_thread(cpu);
+    tls_in_pool = true;
+
+    unsigned seen = 0;
+    for (;;) {
+        /* attente active optionnelle (Config::spin), puis sommeil */
+        for (int spin = 0; spin < cfg_.spin &&
+             generation_.load(std::memory_order_acquire) == seen; ++spin)
+            RN_PAUSE();
+
+        if (generation_.load(std::memory_order_acquire) == seen) {
+            std::unique_lock<std::mutex> lk(m_);
+            cv_.wait(lk, [&] { return stop_ || generation_.load() != seen; });
+            if (stop_) return;
+        }
+        seen = generation_.load(std::memory_order_acquire);
+        if (!join(seen)) continue;                            // tâche déjà close
+
+        work(tid);
+        join_.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/* ───────── Pool de threads persistant du moteur ────────────────── */
+/*  Remplace les régions `#pragma omp parallel` ouvertes à chaque appel
+ *  de couche : les workers sont créés une fois (optionnellement épinglés
+ *  sur des cœurs, dans l'ordre des nœuds NUMA) et attendent les tâches.
+ *
+ *  parallel_for(begin, end, grain, f) découpe [begin, end) en tranches
+ *  de `grain` éléments ; chaque worker reçoit un bloc contigu de
+ *  tranches et vole par la fin chez les autres une fois le sien vidé.
+ *  f(lo, hi, tid) est appelée avec tid dans [0, size()) : le thread
+ *  appelant participe comme tid 0.
+ *
+ *  Exécution directe (inline, tid 0) quand il n'y a qu'une tranche
+ *  (=> `grain` sert de seuil), quand le pool n'a qu'un thread, depuis
+ *  un worker (appel imbriqué), ou quand le pool est déjà occupé par un
+ *  autre appelant (inférences concurrentes) : jamais de sur-souscription.
+ *
+ *  Seuls min(tranches, size()) threads participent : l'appelant ne
+ *  réveille et n'attend que ceux-là. Entre deux tâches, les workers
+ *  dorment (attente passive, cohabitation avec d'autres pools) sauf si
+ *  Config::spin leur accorde une courte attente active. Une exception
+ *  levée par f est relancée dans l'appelant, une fois la tâche close.
+ *
+ *  Les noyaux passent par instance() : pool global, ou pool privé lié
+ *  au thread appelant (bind), ce qui découpe les cœurs entre plusieurs
+ *  entraînements concurrents sans qu'ils se disputent un même pool.
+ */
+class ThreadPool {
+public:
+    struct Config {
+        int              threads = 0;    // 0 : std::thread::hardware_concurrency()
+        bool             pin     = false;// épinglage des workers sur des cœurs
+        std::vector<int> cpus;           // cœurs à utiliser (vide : ordre NUMA)
+        int              spin    = 0;    // pauses actives d'un worker avant de dormir
+    };
+
+    /* (re)crée le pool global ; à appeler hors de tout parallel_for */
+    static void        configure(const Config& cfg);
+    static ThreadPool& instance();
+    static Config      current();                  // config du pool global
+
+    /* pool privé (ex. une voie de balayage) ; bind(p) le substitue au
+       pool global pour le thread appelant — instance() y renvoie p —
+       jusqu'à bind(nullptr) */
+    static std::unique_ptr<ThreadPool> create(const Config& cfg);
+    static void                        bind(ThreadPool* pool);
+
+    int size() const { return static_cast<int>(workers_.size()) + 1; }
+
+    template <class F>
+    void parallel_for(int begin, int end, int grain, F&& f)
+    {
+        using Fd = typename std::remove_reference<F>::type;
+        run([](void* ctx, int lo, int hi, int tid) { (*static_cast<Fd*>(ctx))(lo, hi, tid); },
+            const_cast<void*>(static_cast<const void*>(&f)), begin, end, grain);
+    }
+
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&)            = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+private:
+    using Fn = void (*)(void*, int, int, int);
+
+    explicit ThreadPool(const Config& cfg);
+    void run(Fn fn, void* ctx, int begin, int end, int grain);
+    void worker_loop(int tid, int cpu);
+    bool join(unsigned gen);
+    void work(int tid);
+    int  pop_front(int w);
+    int  steal_back(int w);
+
+    /* file de tranches d'un worker : [front, back) dans un seul mot,
+       le propriétaire avance front, les voleurs reculent back (CAS) */
+    struct alignas(64) Range { std::atomic<uint64_t> fb{ 0 }; };
+
+    Config                   cfg_;
+    std::vector<std::thread> workers_;
+    std::unique_ptr<Range[]> ranges_;
+
+    /* tâche courante */
+    Fn    fn_ = nullptr;
+    void* ctx_ = nullptr;
+    int   begin_ = 0, end_ = 0, grain_ = 1;
+    std::atomic<int> remaining_{ 0 };     // tranches non terminées
+    /* participation : génération (31 bits) | tâche ouverte | workers
+       entrés dans la tâche (32 bits). Un worker n'entre que dans la
+       tâche ouverte de sa génération ; l'appelant ferme puis attend
+       la sortie des seuls entrants. */
+    std::atomic<uint64_t> join_{ 0 };
+    std::exception_ptr    error_;         // première exception de la tâche
+    std::mutex            error_m_;
+
+    std::atomic<bool>       busy_{ false };
+    std::atomic<unsigned>   generation_{ 0 };
+    std::mutex              m_;
+    std::condition_variable cv_;
+    bool                    stop_ = false;
+};
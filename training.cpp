@@ -1,57 +1,242 @@
 #include "training.h"
+#include "cnn.h"
+#include "denseNN.h"
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <exception>
 #include <iostream>
+#include <memory>
 #include <numeric>
 #include <random>
+#include <stdexcept>
+#include <thread>
 #include <vector>
 
-void train_epoch_loop(CNN& net,
+using Clock = std::chrono::steady_clock;
+
+template <class Net>
+double test_accuracy(const Net& net, const Images& Xte, const Labels& Yte)
+{
+    constexpr int TILE = 256;
+    int correct = 0;
+    for (std::size_t first = 0; first < Xte.size(); first += TILE) {
+        const int n = static_cast<int>(std::min<std::size_t>(TILE, Xte.size() - first));
+        const Tensor y = net.infer_batch(Xte, first, n);
+        for (int j = 0; j < n; ++j) {
+            const float* row = &y[static_cast<std::size_t>(j) * NUM_CLASSES];
+            const int pred = static_cast<int>(std::max_element(row, row + NUM_CLASSES) - row);
+            if (pred == Yte[first + j]) ++correct;
+        }
+    }
+    return 100.0 * correct / static_cast<double>(Xte.size());
+}
+
+EarlyStop patience_stop(int patience)
+{
+    auto best  = std::make_shared<double>(-1.0);
+    auto since = std::make_shared<int>(0);
+    return [=](const EpochReport& r) {
+        if (r.test_acc > *best) { *best = r.test_acc; *since = 0; }
+        else ++*since;
+        return *since >= patience;
+    };
+}
+
+/* ───────── Évaluation en arrière-plan ───────── */
+/*  submit() copie les poids (instantané immuable, ~100 Ko pour le CNN)
+    puis rend la main : le thread d'évaluation lit l'instantané par
+    infer, const, pendant que l'époque suivante modifie `net`. Une
+    seule évaluation en vol : submit() attend la précédente. Les deux
+    threads partagent le pool : celui qui le trouve occupé exécute son
+    noyau en ligne, sans sur-souscription. Une exception de l'évaluation
+    (bad_alloc, hook d'arrêt) est relancée dans le thread d'entraînement,
+    au lot suivant ou par wait(), comme ThreadPool::run. */
+template <class Net>
+class AsyncEval {
+public:
+    AsyncEval(const Images& Xte, const Labels& Yte, const EarlyStop& stop)
+        : Xte_(Xte), Yte_(Yte), stop_(stop) {}
+    ~AsyncEval() { if (th_.joinable()) th_.join(); }   // sans relancer
+
+    void submit(const Net& net, int ep, double loss, double train_s)
+    {
+        wait();
+        if (stop_requested()) return;             // arrêt décidé entre-temps
+        auto snap = std::make_shared<const Net>(net);
+        th_ = std::thread([this, snap, ep, loss, train_s] {
+            try {
+                const auto t0 = Clock::now();
+                EpochReport r{ ep, loss, test_accuracy(*snap, Xte_, Yte_), train_s, 0.0 };
+                r.eval_s = std::chrono::duration<double>(Clock::now() - t0).count();
+
+                std::cout << "Epoch "   << r.epoch
+                          << "  loss="      << r.loss
+                          << "  test_acc="  << r.test_acc << '%'
+                          << "  time="      << r.train_s << " s"
+                          << "  (eval "     << r.eval_s << " s, en arrière-plan)\n";
+
+                if (stop_ && stop_(r)) {
+                    stopped_ = snap;
+                    stop_flag_.store(true, std::memory_order_release);
+                }
+            }
+            catch (...) {
+                error_ = std::current_exception();
+                failed_.store(true, std::memory_order_release);
+            }
+        });
+    }
+
+    /* attend l'évaluation en vol et relance son exception éventuelle */
+    void wait()
+    {
+        if (th_.joinable()) th_.join();
+        if (error_) {
+            std::exception_ptr e = error_;
+            error_ = nullptr;
+            std::rethrow_exception(e);
+        }
+    }
+
+    /* sondé avant chaque lot : relance sans attendre la fin de l'époque */
+    bool stop_requested()
+    {
+        if (failed_.load(std::memory_order_acquire)) wait();
+        return stop_flag_.load(std::memory_order_acquire);
+    }
+
+    /* après stop_requested() : poids de l'époque qui a déclenché l'arrêt */
+    void restore(Net& net) { wait(); net = *stopped_; }
+
+private:
+    const Images&                Xte_;
+    const Labels&                Yte_;
+    EarlyStop                    stop_;
+    std::thread                  th_;
+    std::shared_ptr<const Net>   stopped_;
+    std::atomic<bool>            stop_flag_{ false };
+    std::exception_ptr           error_;          // écrit par le thread, lu après join
+    std::atomic<bool>            failed_{ false };
+};
+
+template <class Net>
+double train_epoch(Net& net, const Images& Xtr, const Labels& Ytr,
+                   const std::vector<int>& order, int batch_size,
+                   const std::function<bool()>& stop)
+{
+    /* ---- boucle mini-lots ---- */
+    double loss_sum = 0.0;
+    std::vector<int> batch_idx;
+    for (std::size_t pos = 0; pos < order.size() && !(stop && stop()); pos += batch_size) {
+        std::size_t end = std::min(pos + batch_size, order.size());
+
+        /* indices du lot courant */
+        batch_idx.assign(order.begin() + pos, order.begin() + end);
+
+        /* entraîne et récupère la perte moyenne du lot          *
+         * (=> on la re-multiplie par sa taille pour avoir       *
+         *    la somme des pertes individuelles).                */
+        loss_sum += net.train_batch(Xtr, Ytr,
+                                    batch_idx,
+                                    static_cast<int>(batch_idx.size()))
+                     * static_cast<double>(batch_idx.size());
+    }
+    return loss_sum;
+}
+
+template <class Net>
+void train_epoch_loop(Net& net,
                       const Images&  Xtr, const Labels&  Ytr,
                       const Images&  Xte, const Labels&  Yte,
                       int  epochs,
-                      int  batch_size)
+                      int  batch_size,
+                      const AugmentParams* aug,
+                      const EarlyStop& stop)
 {
     /* --- préparation --- */
+    if (Xtr.empty()) throw std::runtime_error("train_epoch_loop : jeu d'entraînement vide");
     std::vector<int> idx(Xtr.size());
     std::iota(idx.begin(), idx.end(), 0);
     std::mt19937 gen(42);
 
-    for (int ep = 1; ep <= epochs; ++ep) {            /* PARALLEL_CANDIDATE_OpenMP */
-        auto t0 = std::chrono::steady_clock::now();   // départ chrono
+    /* étage d'augmentation (optionnel) : graine fixe => tirages
+       reproductibles pour chaque couple (époque, échantillon) */
+    std::unique_ptr<AugmentPipeline> pipe;
+    if (aug) pipe = std::make_unique<AugmentPipeline>(Xtr, Ytr, *aug, 42u);
+
+    AsyncEval<Net> eval(Xte, Yte, stop);
+    for (int ep = 1; ep <= epochs && !eval.stop_requested(); ++ep) {            /* PARALLEL_CANDIDATE_OpenMP */
+        auto t0 = Clock::now();                       // départ chrono
 
         std::shuffle(idx.begin(), idx.end(), gen);
         double loss_sum = 0.0;
 
-        /* ---- boucle mini-lots ---- */
-        for (std::size_t pos = 0; pos < idx.size(); pos += batch_size) {
-            std::size_t end = std::min(pos + batch_size, idx.size());
+        if (pipe) {
+            /* ---- boucle mini-lots augmentés ---- */
+            pipe->start_epoch(ep, idx, batch_size);
+            Batch b;
+            while (!eval.stop_requested() && pipe->next(b))
+                loss_sum += net.train_batch(b.X, b.Y, b.idx,
+                                            static_cast<int>(b.idx.size()))
+                             * static_cast<double>(b.idx.size());
+        }
+        else
+            loss_sum = train_epoch(net, Xtr, Ytr, idx, batch_size,
+                                   [&] { return eval.stop_requested(); });
 
-            /* indices du lot courant */
-            std::vector<int> batch_idx(idx.begin() + pos, idx.begin() + end);
+        if (eval.stop_requested()) break;             // époque abandonnée
+        eval.submit(net, ep, loss_sum / static_cast<double>(idx.size()),
+                    std::chrono::duration<double>(Clock::now() - t0).count());
+    }
 
-            /* entraîne et récupère la perte moyenne du lot          *
-             * (=> on la re-multiplie par sa taille pour avoir       *
-             *    la somme des pertes individuelles).                */
-            loss_sum += net.train_batch(Xtr, Ytr,
-                                        batch_idx,
-                                        static_cast<int>(batch_idx.size()))
-                         * static_cast<double>(batch_idx.size());
-        }
+    eval.wait();
+    if (eval.stop_requested()) eval.restore(net);
+}
 
-        /* ---- évaluation jeu de test ---- */
-        int correct = 0;
-        for (std::size_t i = 0; i < Xte.size(); ++i)
-            if (net.predict(Xte[i]) == Yte[i]) ++correct;
+template <class Net>
+void train_epoch_loop(Net& net,
+                      IdxStream&     train,
+                      const Images&  Xte, const Labels&  Yte,
+                      int  epochs,
+                      const EarlyStop& stop)
+{
+    AsyncEval<Net> eval(Xte, Yte, stop);
+    for (int ep = 1; ep <= epochs && !eval.stop_requested(); ++ep) {
+        auto t0 = Clock::now();                       // départ chrono
 
-        auto t1 = std::chrono::steady_clock::now();   // arrêt chrono
-        double elapsed_s =
-            std::chrono::duration<double>(t1 - t0).count();
+        /* la taille du jeu n'est connue qu'en fin d'époque */
+        train.start_epoch(ep);
+        double      loss_sum = 0.0;
+        std::size_t seen     = 0;
+        Batch b;
+        while (!eval.stop_requested() && train.next(b)) {
+            const int n = static_cast<int>(b.idx.size());
+            loss_sum += net.train_batch(b.X, b.Y, b.idx, n) * static_cast<double>(n);
+            seen     += n;
+        }
 
-        std::cout << "Epoch "   << ep
-                  << "  loss="      << loss_sum / static_cast<double>(idx.size())
-                  << "  test_acc="  << (100.0 * correct / Xte.size()) << '%'
-                  << "  time="      << elapsed_s << " s\n";
+        if (eval.stop_requested()) break;             // époque abandonnée
+        if (seen == 0)                                // perte moyenne indéfinie
+            throw std::runtime_error("train_epoch_loop : flux d'entraînement vide");
+        eval.submit(net, ep, loss_sum / static_cast<double>(seen),
+                    std::chrono::duration<double>(Clock::now() - t0).count());
     }
+
+    eval.wait();
+    if (eval.stop_requested()) eval.restore(net);
 }
+
+template void train_epoch_loop<CNN>    (CNN&,     const Images&, const Labels&, const Images&, const Labels&,
+                                        int, int, const AugmentParams*, const EarlyStop&);
+template void train_epoch_loop<DenseNN>(DenseNN&, const Images&, const Labels&, const Images&, const Labels&,
+                                        int, int, const AugmentParams*, const EarlyStop&);
+template void train_epoch_loop<CNN>    (CNN&,     IdxStream&, const Images&, const Labels&, int, const EarlyStop&);
+template void train_epoch_loop<DenseNN>(DenseNN&, IdxStream&, const Images&, const Labels&, int, const EarlyStop&);
+template double train_epoch<CNN>    (CNN&,     const Images&, const Labels&, const std::vector<int>&, int,
+                                     const std::function<bool()>&);
+template double train_epoch<DenseNN>(DenseNN&, const Images&, const Labels&, const std::vector<int>&, int,
+                                     const std::function<bool()>&);
+template double test_accuracy<CNN>    (const CNN&,     const Images&, const Labels&);
+template double test_accuracy<DenseNN>(const DenseNN&, const Images&, const Labels&);
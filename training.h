@@ -1,12 +1,69 @@
 #pragma once
-#include "cnn.h"
+#include "augment.h"
+#include "idx_stream.h"
 #include "tensor.h"
+#include <functional>
+
+/*  Net : CNN ou DenseNN (instanciés dans training.cpp). */
+
+/* ───────── Compte rendu d'époque ───────── */
+struct EpochReport {
+    int    epoch;
+    double loss;               // perte moyenne d'entraînement
+    double test_acc;           // % sur le jeu de test
+    double train_s;            // durée de l'époque (hors évaluation)
+    double eval_s;             // durée de l'évaluation (en arrière-plan)
+};
+
+/*  Hook d'arrêt anticipé : appelé avec chaque compte rendu, depuis le
+ *  thread d'évaluation, dans l'ordre des époques. Renvoie true pour
+ *  arrêter : l'entraînement s'interrompt au mini-lot suivant et `net`
+ *  reprend les poids de l'époque évaluée.
+ */
+using EarlyStop = std::function<bool(const EpochReport&)>;
+
+/* arrêt après `patience` époques sans amélioration de test_acc */
+EarlyStop patience_stop(int patience);
 
 /*  Entraîne le réseau ‟net” pendant `epochs` époques
  *  en utilisant un mini-lot de taille `batch_size`.
+ *  Si `aug` est fourni, les mini-lots sont augmentés à la volée
+ *  par un AugmentPipeline qui tourne en parallèle de l'entraînement.
+ *
+ *  En fin d'époque, les poids sont copiés et évalués sur le jeu de
+ *  test par un thread d'arrière-plan pendant que l'époque suivante
+ *  s'entraîne ; les comptes rendus s'affichent à leur arrivée.
  */
-void train_epoch_loop(CNN&  net,
+template <class Net>
+void train_epoch_loop(Net&  net,
                       const Images&  Xtr, const Labels&  Ytr,
                       const Images&  Xte, const Labels&  Yte,
                       int  epochs,
-                      int  batch_size);
+                      int  batch_size,
+                      const AugmentParams* aug = nullptr,
+                      const EarlyStop& stop = {});
+
+/*  Variante hors mémoire : les mini-lots viennent d'un IdxStream
+ *  (fragments IDX bruts ou .gz décodés en arrière-plan, mélange
+ *  dans un tampon borné). Le jeu de test reste en mémoire. Une époque
+ *  sans aucun échantillon lève std::runtime_error.
+ */
+template <class Net>
+void train_epoch_loop(Net&  net,
+                      IdxStream&     train,
+                      const Images&  Xte, const Labels&  Yte,
+                      int  epochs,
+                      const EarlyStop& stop = {});
+
+/*  Une époque sans évaluation : mini-lots de `batch_size` pris dans
+ *  l'ordre `order`. S'interrompt avant un lot si `stop` renvoie true.
+ *  Renvoie la somme des pertes individuelles.
+ */
+template <class Net>
+double train_epoch(Net& net, const Images& Xtr, const Labels& Ytr,
+                   const std::vector<int>& order, int batch_size,
+                   const std::function<bool()>& stop = {});
+
+/* précision (%) via infer_batch (chemin CSR une fois élagué) */
+template <class Net>
+double test_accuracy(const Net& net, const Images& Xte, const Labels& Yte);